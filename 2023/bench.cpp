@@ -0,0 +1,55 @@
+#include "strokes.hpp"
+#include "../common/bench.hpp"
+#include "../common/trace.hpp"
+#include "../common/random.hpp"
+
+#include "../AA/include/AA/algorithm/arithmetic.hpp"
+#include "../AA/include/AA/algorithm/init.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdlib>
+
+
+
+// Matuoja potėpių integravimą be lango. Gradientas skaičiuojamas procesoriumi, o ne piešiamas.
+int main(const int argc, char ** const argv) {
+	static constexpr size_t stroke_count = 5000;
+
+	const int status = bench::run(argc, argv, [](bench::report & out, const bench::resolution & r, const uint64_t seed) static -> void {
+		rng::stream rand = rng::stream{seed};
+		bench::stopwatch watch;
+
+		const sf::Vector2f window_size = sf::Vector2f{aa::cast<float>(r.width), aa::cast<float>(r.height)};
+		sf::Image image, grad;
+		image.create(r.width, r.height, sf::Color::Black);
+		grad.create(r.width, r.height);
+		{
+			const std::array corners = {random_color<255>(rand), random_color<255>(rand), random_color<255>(rand), random_color<255>(rand)};
+			for (uint32_t y = 0; y != r.height; ++y) {
+				const float v = aa::cast<float>(y) / aa::cast<float>(r.height - 1);
+				const sf::Color left = lerp_color(corners[0], corners[2], v), right = lerp_color(corners[1], corners[3], v);
+				for (uint32_t x = 0; x != r.width; ++x) {
+					grad.setPixel(x, y, lerp_color(left, right, aa::cast<float>(x) / aa::cast<float>(r.width - 1)));
+					if (bench::in_mask(x, y, r.width, r.height)) image.setPixel(x, y, sf::Color::White);
+				}
+			}
+		}
+		const stroke_field field = make_stroke_field(random_bounded_color<127>(rand), rand);
+		const double setup = watch.lap();
+
+		sf::VertexArray line = sf::VertexArray{sf::TriangleStrip};
+		size_t vertex_count = 0;
+		aa::repeat(stroke_count, [&]() -> void {
+			integrate_stroke(line, field, image, grad, window_size, rand);
+			vertex_count += line.getVertexCount();
+		});
+		const double integrate = watch.lap();
+
+		out.record("2023", "integrate_stroke", r, seed, {{"setup", setup}, {"integrate", integrate}}, {
+			{"strokes_per_second", aa::cast<double>(stroke_count) / integrate},
+			{"vertices_per_second", aa::cast<double>(vertex_count) / integrate}});
+	});
+	trace::finish("trace.json", stderr);
+	return status;
+}
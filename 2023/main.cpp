@@ -1,15 +1,11 @@
-#define GLM_FORCE_CXX2A
-#define GLM_FORCE_EXPLICIT_CTOR
-#define GLM_FORCE_INTRINSICS
-#define GLM_FORCE_SIZE_T_LENGTH
-#include <glm/gtc/noise.hpp>
-#include <glm/gtc/random.hpp>
-#include <glm/gtc/constants.hpp>
-#include <glm/gtx/rotate_vector.hpp>
+#include "strokes.hpp"
 
 #include "../AA/include/AA/algorithm/arithmetic.hpp"
 #include "../AA/include/AA/algorithm/int_math.hpp"
 #include "../AA/include/AA/algorithm/init.hpp"
+#include "../common/random.hpp"
+#include "../common/save_queue.hpp"
+#include "../common/trace.hpp"
 
 #include <SFML/Graphics.hpp>
 
@@ -23,45 +19,13 @@
 #include <chrono>
 #include <string>
 
-using namespace std::placeholders;
 
 
-
-template<std::floating_point T>
-constexpr sf::Color lerp_color(const sf::Color c1, const sf::Color c2, const T amt) {
-	return sf::Color{
-		aa::round_lerp(c1.r, c2.r, amt),
-		aa::round_lerp(c1.g, c2.g, amt),
-		aa::round_lerp(c1.b, c2.b, amt)};
-}
-
-// https://en.wikipedia.org/wiki/HSL_and_HSV#Lightness
-template<uint8_t M = 0, uint8_t A = 255>
-constexpr sf::Color random_color() {
-	const sf::Color color = sf::Color{(glm::linearRand<uint32_t>(0x00'00'00'00u, 0x00'FF'FF'FFu) << 8) | A};
-	if constexpr (M) {
-		switch (glm::linearRand<uint32_t>(0, 2)) {
-			case 0: return (color.r < M ? sf::Color{M, color.g, color.b, A} : color);
-			case 1: return (color.g < M ? sf::Color{color.r, M, color.b, A} : color);
-			case 2: return (color.b < M ? sf::Color{color.r, color.g, M, A} : color);
-		}
-		std::unreachable();
-	}
-	return color;
-}
-
-template<uint8_t M = 255>
-constexpr sf::Color random_bounded_color() {
-	return sf::Color{
-		aa::cast<uint8_t>(glm::linearRand<uint32_t>(0, M)),
-		aa::cast<uint8_t>(glm::linearRand<uint32_t>(0, M)),
-		aa::cast<uint8_t>(glm::linearRand<uint32_t>(0, M))};
-}
-
-int main() {
+// Usage: main [seed]. Be seed imamas laikrodis.
+int main(const int argc, char ** const argv) {
 	std::ios_base::sync_with_stdio(false);
 	std::filesystem::create_directory("output");
-	std::srand(aa::cast<uint32_t>(std::chrono::system_clock::now().time_since_epoch().count()));
+	rng::stream rand = rng::stream{rng::parse_seed((argc == 2) ? std::optional<std::string_view>{argv[1]} : std::nullopt)};
 
 	sf::RenderWindow window = sf::RenderWindow{sf::VideoMode::getDesktopMode(),
 		"Thank_you_2023", sf::Style::Fullscreen, sf::ContextSettings{0, 0, 8}};
@@ -87,70 +51,48 @@ int main() {
 	const sf::Image image = (screenshot.update(window), screenshot).copyToImage();
 	const sf::RenderStates states = sf::RenderStates{sf::BlendMax};
 
-	std::string str;
-	str.reserve(50);
+	// Paveikslas nuskaitomas iš lango šioje gijoje, o koduojamas ir įrašomas atskiroje.
+	save_queue<sf::Image> saves;
+	saves.start([](const sf::Image & image, const std::string & path) static -> bool { return image.saveToFile(path); });
 	sf::Event event;
 
 	sf::VertexArray line = sf::VertexArray{sf::TriangleStrip};
 	const auto draw = [&]() -> void {
+		const trace::scope whole = trace::scope{"draw"};
 		{
+			const trace::scope phase = trace::scope{"gradient"};
 			const std::array<sf::Vertex, 4> mask = {
-				sf::Vertex{sf::Vector2f{0, 0}, random_color<255>()},
-				sf::Vertex{sf::Vector2f{window_size.x, 0}, random_color<255>()},
-				sf::Vertex{sf::Vector2f{0, window_size.y}, random_color<255>()},
-				sf::Vertex{window_size, random_color<255>()},
+				sf::Vertex{sf::Vector2f{0, 0}, random_color<255>(rand)},
+				sf::Vertex{sf::Vector2f{window_size.x, 0}, random_color<255>(rand)},
+				sf::Vertex{sf::Vector2f{0, window_size.y}, random_color<255>(rand)},
+				sf::Vertex{window_size, random_color<255>(rand)},
 			};
 			window.draw(mask.data(), mask.size(), sf::PrimitiveType::TriangleStrip);
 		}
-		const sf::Image grad = (screenshot.update(window), screenshot).copyToImage();
-		const sf::Color background = random_bounded_color<127>();
+		const sf::Image grad = [&]() -> sf::Image {
+			const trace::scope phase = trace::scope{"readback"};
+			return (screenshot.update(window), screenshot).copyToImage();
+		}();
+		const sf::Color background = random_bounded_color<127>(rand);
 		window.clear(background);
 
-		const size_t lifetime = glm::linearRand<size_t>(100, 200);
-		const size_t decay = std::ranges::max(aa::cast<size_t>(aa::cast<float>(lifetime) * 0.025f), 1uz);
-		const float radius = glm::linearRand<float>(5, 30);
-		const float freq = glm::linearRand<float>(0.0002f, 0.001f);
-		const glm::vec2 phase = glm::linearRand(glm::vec2{-5000.f}, glm::vec2{5000.f});
-		aa::repeat(5000, [&]() -> void {
-			line.clear();
-
-			glm::vec2 pos;
-			do {
-				pos = glm::linearRand(glm::vec2{10.f}, std::bit_cast<glm::vec2>(window_size) - 11.f);
-			} while (image.getPixel(aa::cast<uint32_t>(pos.x), aa::cast<uint32_t>(pos.y)) == sf::Color::White);
-			const sf::Color c2 = grad.getPixel(aa::cast<uint32_t>(pos.x), aa::cast<uint32_t>(pos.y));
-			size_t life = 0; do {
-				const float t = aa::cast<float>(life) / aa::cast<float>(lifetime);
-
-				// https://www.bit-101.com/blog/2021/07/mapping-perlin-noise-to-angles/
-				const glm::vec2 heading = glm::rotate(glm::vec2{1.f, 0.f},
-					aa::norm_map<_1>(glm::simplex((pos * freq) + phase), -0.5f, 1.f, glm::two_pi<float>()));
-
-				const glm::vec2 point = heading * std::lerp(radius, 0.5f, t);
-
-				const sf::Color color = sf::Color{lerp_color(background, c2, t).toInteger()
-					& aa::round_lerp(0xFF'FF'FF'00u, 0xFF'FF'FF'FFu, std::cbrt(t))};
-
-				// https://gamedev.stackexchange.com/questions/70075/how-can-i-find-the-perpendicular-to-a-2d-vector
-				line.append(sf::Vertex{std::bit_cast<sf::Vector2f>(pos + glm::vec2{-point.y, point.x}), color});
-				line.append(sf::Vertex{std::bit_cast<sf::Vector2f>(pos + glm::vec2{point.y, -point.x}), color});
-
-				pos += heading;
-				if (pos.x < 0.f || window_size.x <= pos.x ||
-					pos.y < 0.f || window_size.y <= pos.y || life == lifetime) break;
-				if (image.getPixel(aa::cast<uint32_t>(pos.x), aa::cast<uint32_t>(pos.y)) == sf::Color::White) {
-					life += std::ranges::min(lifetime - life, decay);
-				} else ++life;
-			} while (true);
-
-			window.draw(line, states);
-		});
+		const stroke_field field = make_stroke_field(background, rand);
+		{
+			const trace::scope phase = trace::scope{"strokes"};
+			aa::repeat(5000, [&]() -> void {
+				integrate_stroke(line, field, image, grad, window_size, rand);
+				window.draw(line, states);
+			});
+		}
 
+		const trace::scope phase = trace::scope{"display"};
 		window.display();
 	};
 	draw();
 
 	while (window.isOpen()) {
+		// Kaip ir anksčiau, įrašymo rezultatas netikrinamas, SFML pati praneša apie klaidas.
+		saves.consume([](const std::string &, const bool) static -> void {});
 		while (window.pollEvent(event)) {
 			switch (event.type) {
 				case sf::Event::Closed:
@@ -164,10 +106,10 @@ int main() {
 							break;
 
 						case sf::Keyboard::S:
+							// Ctrl+Shift+S – PNG be nuostolių.
 							if (event.key.control) {
-								std::format_to(std::back_inserter((str.clear(), str)), "output/img_{}.jpg",
-									std::chrono::system_clock::now().time_since_epoch().count());
-								(screenshot.update(window), screenshot).copyToImage().saveToFile(str);
+								saves.push((screenshot.update(window), screenshot).copyToImage(), std::format("output/img_{}.{}",
+									std::chrono::system_clock::now().time_since_epoch().count(), (event.key.shift ? "png" : "jpg")));
 							}
 							break;
 
@@ -184,5 +126,5 @@ int main() {
 		}
 	}
 
-	return EXIT_SUCCESS;
+	return (trace::finish("output/trace.json") ? EXIT_SUCCESS : EXIT_FAILURE);
 }
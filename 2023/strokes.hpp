@@ -0,0 +1,120 @@
+#pragma once
+
+#define GLM_FORCE_CXX2A
+#define GLM_FORCE_EXPLICIT_CTOR
+#define GLM_FORCE_INTRINSICS
+#define GLM_FORCE_SIZE_T_LENGTH
+#include <glm/gtc/noise.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/rotate_vector.hpp>
+
+#include "../AA/include/AA/algorithm/arithmetic.hpp"
+#include "../AA/include/AA/algorithm/int_math.hpp"
+#include "../common/random.hpp"
+#include "../common/trace.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <cmath>
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <utility>
+
+
+
+template<std::floating_point T>
+constexpr sf::Color lerp_color(const sf::Color c1, const sf::Color c2, const T amt) {
+	return sf::Color{
+		aa::round_lerp(c1.r, c2.r, amt),
+		aa::round_lerp(c1.g, c2.g, amt),
+		aa::round_lerp(c1.b, c2.b, amt)};
+}
+
+// https://en.wikipedia.org/wiki/HSL_and_HSV#Lightness
+template<uint8_t M = 0, uint8_t A = 255>
+constexpr sf::Color random_color(rng::stream & rand) {
+	const sf::Color color = sf::Color{(rand.between<uint32_t>(0x00'00'00'00u, 0x00'FF'FF'FFu) << 8) | A};
+	if constexpr (M) {
+		switch (rand.between<uint32_t>(0, 2)) {
+			case 0: return (color.r < M ? sf::Color{M, color.g, color.b, A} : color);
+			case 1: return (color.g < M ? sf::Color{color.r, M, color.b, A} : color);
+			case 2: return (color.b < M ? sf::Color{color.r, color.g, M, A} : color);
+		}
+		std::unreachable();
+	}
+	return color;
+}
+
+template<uint8_t M = 255>
+constexpr sf::Color random_bounded_color(rng::stream & rand) {
+	return sf::Color{
+		aa::cast<uint8_t>(rand.between<uint32_t>(0, M)),
+		aa::cast<uint8_t>(rand.between<uint32_t>(0, M)),
+		aa::cast<uint8_t>(rand.between<uint32_t>(0, M))};
+}
+
+// Atsitiktiniai vieno draw() kvietimo parametrai, bendri visiems jo potėpiams.
+struct stroke_field {
+	sf::Color background;
+	size_t lifetime, decay;
+	float radius, freq;
+	glm::vec2 phase;
+};
+
+constexpr stroke_field make_stroke_field(const sf::Color background, rng::stream & rand) {
+	const size_t lifetime = rand.between<size_t>(100, 200);
+	return {
+		background, lifetime,
+		std::ranges::max(aa::cast<size_t>(aa::cast<float>(lifetime) * 0.025f), 1uz),
+		rand.between(5.f, 30.f),
+		rand.between(0.0002f, 0.001f),
+		glm::vec2{rand.between(-5000.f, 5000.f), rand.between(-5000.f, 5000.f)}};
+}
+
+// decay_steps – žingsniai, kuriais potėpis buvo ant teksto ir seno greičiau.
+namespace probes {
+	inline trace::counter rejected_starts{"stroke.rejected_starts"}, decay_steps{"stroke.decay_steps"};
+	inline trace::histogram steps{"stroke.steps", true};
+}
+
+// Vieno potėpio integravimas triukšmo lauke. Ankstesnes line viršūnes ištrina.
+constexpr void integrate_stroke(sf::VertexArray & line, const stroke_field & field,
+	const sf::Image & image, const sf::Image & grad, const sf::Vector2f window_size, rng::stream & rand)
+{
+	const auto & [background, lifetime, decay, radius, freq, phase] = field;
+	line.clear();
+
+	glm::vec2 pos;
+	do {
+		pos = glm::vec2{rand.between(10.f, window_size.x - 11.f), rand.between(10.f, window_size.y - 11.f)};
+		if (image.getPixel(aa::cast<uint32_t>(pos.x), aa::cast<uint32_t>(pos.y)) != sf::Color::White) break;
+		probes::rejected_starts.add();
+	} while (true);
+	const sf::Color c2 = grad.getPixel(aa::cast<uint32_t>(pos.x), aa::cast<uint32_t>(pos.y));
+	size_t life = 0; do {
+		const float t = aa::cast<float>(life) / aa::cast<float>(lifetime);
+
+		// https://www.bit-101.com/blog/2021/07/mapping-perlin-noise-to-angles/
+		const glm::vec2 heading = glm::rotate(glm::vec2{1.f, 0.f},
+			aa::norm_map<std::placeholders::_1>(glm::simplex((pos * freq) + phase), -0.5f, 1.f, glm::two_pi<float>()));
+
+		const glm::vec2 point = heading * std::lerp(radius, 0.5f, t);
+
+		const sf::Color color = sf::Color{lerp_color(background, c2, t).toInteger()
+			& aa::round_lerp(0xFF'FF'FF'00u, 0xFF'FF'FF'FFu, std::cbrt(t))};
+
+		// https://gamedev.stackexchange.com/questions/70075/how-can-i-find-the-perpendicular-to-a-2d-vector
+		line.append(sf::Vertex{std::bit_cast<sf::Vector2f>(pos + glm::vec2{-point.y, point.x}), color});
+		line.append(sf::Vertex{std::bit_cast<sf::Vector2f>(pos + glm::vec2{point.y, -point.x}), color});
+
+		pos += heading;
+		if (pos.x < 0.f || window_size.x <= pos.x ||
+			pos.y < 0.f || window_size.y <= pos.y || life == lifetime) break;
+		if (image.getPixel(aa::cast<uint32_t>(pos.x), aa::cast<uint32_t>(pos.y)) == sf::Color::White) {
+			life += std::ranges::min(lifetime - life, decay);
+			probes::decay_steps.add();
+		} else ++life;
+	} while (true);
+	probes::steps.add(line.getVertexCount() / 2);
+}
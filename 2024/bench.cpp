@@ -0,0 +1,60 @@
+#include "growth.hpp"
+#include "../common/bench.hpp"
+#include "../common/random.hpp"
+#include "../common/trace.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../AA/include/AA/container/fixed_vector.hpp"
+
+#include <cstdlib>
+
+
+
+// Matuoja spalvų medžio artimiausios spalvos paieškos ir pažymėjimo ciklą be lango.
+int main(const int argc, char ** const argv) {
+	bench::stopwatch watch;
+	packed_tree<> tree;
+	tree.build();
+	const double build_tree = watch.lap();
+	// Kaip main antrą kartą: medis atvaizduojamas iš failo, kurį įrašė pirmas paleidimas, ir paieška vyksta jame.
+	if (!tree.save("color_tree.bin")) return EXIT_FAILURE;
+	watch.lap();
+	if (!tree.open("color_tree.bin")) return EXIT_FAILURE;
+	const double map_tree = watch.lap();
+	free_colors<> colors = free_colors<>{tree};
+
+	const int status = bench::run(argc, argv, [&](bench::report & out, const bench::resolution & r, const uint64_t seed) -> void {
+		const sf::Vector2u window_size = {r.width, r.height};
+		sf::Image smoke = sf::Image{window_size, sf::Color::Black};
+		for (uint32_t y = 0; y != r.height; ++y) {
+			for (uint32_t x = 0; x != r.width; ++x) {
+				if (bench::in_mask(x, y, r.width, r.height)) smoke.setPixel({x, y}, sf::Color::White);
+			}
+		}
+
+		aa::pmr::fixed_array<sf::Color> smoke_data = {window_size.x * window_size.y,
+			reinterpret_cast<sf::Color *>(const_cast<std::uint8_t *>(smoke.getPixelsPtr()))};
+
+		const text_mask text = text_mask{smoke_data};
+
+		frontier neighbors = frontier{text.count, smoke_data.size() - text.count};
+		occupancy occupied = occupancy{smoke_data.size()};
+
+		rng::stream rand = rng::stream{seed};
+		watch.lap();
+		occupied.restart();
+		colors.restart();
+		const double restart = watch.lap();
+
+		grow(smoke_data, text.bits, neighbors, occupied, colors, window_size, rand);
+		const double growth = watch.lap();
+
+		out.record("2024", "tree_grow", r, seed, {{"build_tree", build_tree}, {"map_tree", map_tree}, {"restart", restart}, {"grow", growth}},
+			{{"pixels_per_second", aa::cast<double>(smoke_data.size()) / growth}});
+	});
+	// Kaip ir 2025, suvestinė nemaišoma su JSON.
+	trace::finish("trace.json", stderr);
+	return status;
+}
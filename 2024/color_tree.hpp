@@ -0,0 +1,236 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../AA/include/AA/container/fixed_vector.hpp"
+#include "../common/bit_mask.hpp"
+#include "../common/color_metric.hpp"
+#include "../common/mapped_file.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+
+
+
+// Supakuotas R-medis visoms 2^24 spalvoms METRIC erdvėje (žr. common/color_metric.hpp). Spalvos surikiuotos Mortono tvarka
+// pagal jų METRIC koordinates ir sugrupuotos po fanout: lygio L mazgas i apima (L - 1) lygio mazgus [fanout i, fanout (i + 1)),
+// o 1 lygio mazgas – lapus, t. y. spalvas. 2^24 = 16^6, todėl medis pilnas ir vaikų rodyklių nereikia. Po build() nekinta,
+// todėl vienas medis bendras visiems paleidimams; kurios spalvos jau panaudotos, saugo free_colors.
+// Be rodyklių medis nepriklauso nuo adreso, todėl save() jį įrašo į failą, o open() atvaizduoja tik skaitymui ir paieška
+// vyksta tiesiog atvaizduotuose puslapiuose (žr. load()).
+template<class METRIC = metric::srgb>
+struct packed_tree {
+	static constexpr uint32_t fanout = 16, height = 6, color_count = 1u << 24;
+
+	struct box {
+		metric::point lo, hi;
+	};
+
+	// Lygio level (1..height) mazgų skaičius ir pirmo jų indeksas boxes masyve.
+	static constexpr uint32_t level_size(const uint32_t level) {
+		return color_count >> (4 * level);
+	}
+
+	static constexpr size_t first(const uint32_t level) {
+		size_t index = 0;
+		for (uint32_t l = 1; l != level; ++l) index += level_size(l);
+		return index;
+	}
+
+	static constexpr size_t box_count = first(height + 1);
+
+	// Failo pradžia, po jos nuo header_size – tas pats blokas, kaip atmintyje. Failas tinka tik tokiai pačiai METRIC
+	// ir baitų tvarkai, todėl antraštėje yra kelių spalvų koordinatės ir žinomas žodis.
+	struct file_header {
+		std::array<char, 8> magic = {'A', 'A', 'T', 'R', 'E', 'E', '0', '1'};
+		uint32_t byte_order = 0x01'02'03'04u, fanout = packed_tree::fanout, height = packed_tree::height, color_count = packed_tree::color_count;
+		std::array<metric::point, 4> fingerprint = {
+			METRIC::coordinates(0x00'00'00u), METRIC::coordinates(0xFF'FF'FFu), METRIC::coordinates(0x12'34'56u), METRIC::coordinates(0xC0'80'40u)};
+		uint64_t storage_size = packed_tree::storage_size;
+
+		constexpr bool operator==(const file_header &) const = default;
+	};
+
+	static constexpr size_t storage_size = box_count * sizeof(box) + color_count * sizeof(uint32_t), header_size = 4096;
+
+	// Vienas blokas be rodyklių: pirma visų lygių gretasieniai, po jų – spalvos. Jis arba storage (build()), arba file (open()).
+	std::unique_ptr<std::byte[]> storage;
+	mapped_file file;
+	std::span<const box> boxes;
+	std::span<const uint32_t> colors;
+
+	constexpr void point_to(const std::byte * const block) & {
+		boxes = {std::bit_cast<const box *>(block), box_count};
+		colors = {std::bit_cast<const uint32_t *>(block + box_count * sizeof(box)), color_count};
+	}
+
+	// Rikiavimas užtrunka kelias sekundes, todėl medis kuriamas kartą.
+	void build() & {
+		file.close();
+		storage = std::make_unique_for_overwrite<std::byte[]>(storage_size);
+		box * const boxes = std::bit_cast<box *>(storage.get());
+		uint32_t * const colors = std::bit_cast<uint32_t *>(storage.get() + box_count * sizeof(box));
+
+		// Koordinatės ištempiamos į 10 bitų, raktas – Mortono kodas, o žemiausi 24 bitai – pati spalva.
+		metric::point lo = {INT32_MAX, INT32_MAX, INT32_MAX}, hi = {INT32_MIN, INT32_MIN, INT32_MIN};
+		for (uint32_t color = 0; color != color_count; ++color) {
+			const metric::point p = METRIC::coordinates(color);
+			for (size_t i = 0; i != 3; ++i) {
+				lo[i] = std::ranges::min(lo[i], p[i]);
+				hi[i] = std::ranges::max(hi[i], p[i]);
+			}
+		}
+		const std::unique_ptr keys = std::make_unique_for_overwrite<uint64_t[]>(color_count);
+		for (uint32_t color = 0; color != color_count; ++color) {
+			const metric::point p = METRIC::coordinates(color);
+			uint64_t morton = 0;
+			for (size_t i = 0; i != 3; ++i) {
+				const uint64_t q = aa::cast<uint64_t>(p[i] - lo[i]) * 1024 / (aa::cast<uint64_t>(hi[i] - lo[i]) + 1);
+				for (uint32_t bit = 0; bit != 10; ++bit) morton |= ((q >> bit) & 1) << (3 * bit + (2 - i));
+			}
+			keys[color] = (morton << 24) | color;
+		}
+		std::ranges::sort(std::span{keys.get(), color_count});
+		for (uint32_t i = 0; i != color_count; ++i) colors[i] = aa::cast<uint32_t>(keys[i] & 0xFF'FF'FFu);
+
+		const auto merge = [](box & to, const metric::point & l, const metric::point & h) static -> void {
+			for (size_t i = 0; i != 3; ++i) {
+				to.lo[i] = std::ranges::min(to.lo[i], l[i]);
+				to.hi[i] = std::ranges::max(to.hi[i], h[i]);
+			}
+		};
+		std::ranges::fill_n(boxes, aa::sign(box_count), box{{INT32_MAX, INT32_MAX, INT32_MAX}, {INT32_MIN, INT32_MIN, INT32_MIN}});
+		for (uint32_t i = 0; i != color_count; ++i) {
+			const metric::point p = METRIC::coordinates(colors[i]);
+			merge(boxes[first(1) + i / fanout], p, p);
+		}
+		for (uint32_t level = 2; level <= height; ++level) {
+			for (uint32_t i = 0; i != level_size(level - 1); ++i) {
+				const box & child = boxes[first(level - 1) + i];
+				merge(boxes[first(level) + i / fanout], child.lo, child.hi);
+			}
+		}
+
+		point_to(storage.get());
+	}
+
+	// Ankstesnio save() failas. Jei jo nėra arba jis kitam medžiui, grąžina false, o build() sukurtas medis (jei buvo) lieka.
+	constexpr bool open(const char * const path) & {
+		if (!file.open_read_only(path) || file.get_size() != header_size + storage_size
+			|| *std::bit_cast<const file_header *>(file.data()) != file_header{}) {
+			file.close();
+			return false;
+		}
+		point_to(file.data() + header_size);
+		storage.reset();
+		return true;
+	}
+
+	// Įrašo į laikiną failą ir tik tada pervadina, kad nutraukus neliktų pusiau įrašyto medžio.
+	bool save(const char * const path) const & {
+		const std::filesystem::path partial = std::filesystem::path{path} += ".part";
+		{
+			mapped_file out;
+			if (!out.open(partial.string().data(), header_size + storage_size, false)) return false;
+			std::ranges::construct_at(std::bit_cast<file_header *>(out.data()));
+			std::memcpy(out.data() + header_size, boxes.data(), storage_size);
+			if (!out.flush()) return false;
+		}
+		std::error_code error;
+		std::filesystem::rename(partial, path, error);
+		return !error;
+	}
+
+	// Atvaizduoja path, o jei jo dar nėra (ar jis kitam medžiui) – sukuria, įrašo ir atvaizduoja. Medis paruoštas bet kuriuo atveju,
+	// false – tik tai, kad įrašyti nepavyko ir kitą kartą jis vėl bus kuriamas.
+	bool load(const char * const path) & {
+		if (open(path)) return true;
+		build();
+		return save(path) && open(path);
+	}
+};
+
+// Laisvos spalvos viename paleidime: kiekvienam packed_tree mazgui – kiek po juo liko laisvų spalvų, lapams – bitas.
+// Pats medis nekopijuojamas ir nekeičiamas, o naujas paleidimas tik užpildo skaičius iš naujo per O(mazgų).
+template<class METRIC = metric::srgb>
+struct free_colors {
+	using tree_type = packed_tree<METRIC>;
+
+	const tree_type & tree;
+	aa::fixed_array<uint32_t> counts;
+	aa::fixed_array<uint64_t> used_words;
+	bit_mask used;
+
+	struct query {
+		metric::point target;
+		uint32_t best_distance, best;
+	};
+
+	explicit free_colors(const tree_type & t)
+		: tree{t}, counts{tree_type::box_count}, used_words{bit_mask::word_count(tree_type::color_count)}, used{used_words.data()}
+	{
+		restart();
+	}
+
+	// Vaikai lankomi didėjančio atstumo tvarka, o tie, kurie ne arčiau už geriausią rastą spalvą, nukertami.
+	template<uint32_t L>
+	constexpr void search(query & q, const uint32_t node) const & {
+		if constexpr (L == 1) {
+			for (uint32_t i = node * tree_type::fanout, end = i + tree_type::fanout; i != end; ++i) {
+				if (used.test(i)) continue;
+				const uint32_t distance = metric::squared_distance(q.target, METRIC::coordinates(tree.colors[i]));
+				if (distance < q.best_distance) {
+					q.best_distance = distance;
+					q.best = i;
+				}
+			}
+		} else {
+			std::array<std::pair<uint32_t, uint32_t>, tree_type::fanout> children;
+			size_t size = 0;
+			for (uint32_t child = node * tree_type::fanout, end = child + tree_type::fanout; child != end; ++child) {
+				const size_t index = tree_type::first(L - 1) + child;
+				if (!counts[index]) continue;
+
+				const typename tree_type::box & b = tree.boxes[index];
+				const std::pair<uint32_t, uint32_t> entry = {metric::squared_distance(q.target, {std::ranges::clamp(q.target[0], b.lo[0], b.hi[0]),
+					std::ranges::clamp(q.target[1], b.lo[1], b.hi[1]), std::ranges::clamp(q.target[2], b.lo[2], b.hi[2])}), child};
+				size_t j = size++;
+				for (; j && children[j - 1].first > entry.first; --j) children[j] = children[j - 1];
+				children[j] = entry;
+			}
+			for (const auto & [distance, child] : std::span{children.data(), size}) {
+				if (distance >= q.best_distance) break;
+				search<L - 1>(q, child);
+			}
+		}
+	}
+
+	constexpr void restart() & {
+		for (uint32_t level = 1; level <= tree_type::height; ++level) {
+			std::ranges::fill_n(counts.data() + tree_type::first(level), aa::sign(tree_type::level_size(level)), 1u << (4 * level));
+		}
+		used.clear(tree_type::color_count);
+	}
+
+	// Artimiausia pagal METRIC laisva spalva, iš lygių – pirma rasta. Grąžina jos vietą medyje (žr. claim()) arba nullopt, jei laisvų nebeliko.
+	constexpr std::optional<uint32_t> nearest(const uint32_t color) const & {
+		if (!counts[tree_type::first(tree_type::height)]) return std::nullopt;
+
+		query q = {METRIC::coordinates(color), aa::numeric_max, 0};
+		search<tree_type::height>(q, 0);
+		return q.best;
+	}
+
+	// Pažymi vietoje position esančią (laisvą) spalvą panaudota ir ją grąžina.
+	constexpr uint32_t claim(const uint32_t position) & {
+		used.set(position);
+		for (uint32_t level = 1; level <= tree_type::height; ++level) --counts[tree_type::first(level) + (position >> (4 * level))];
+		return tree.colors[position];
+	}
+};
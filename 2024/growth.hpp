@@ -0,0 +1,159 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../AA/include/AA/container/fixed_vector.hpp"
+#include "../common/bit_mask.hpp"
+#include "../common/color_metric.hpp"
+#include "../common/random.hpp"
+#include "../common/trace.hpp"
+#include "color_tree.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+
+
+// Matuojamas rasto atstumo kvadratas ir paieškos bei pažymėjimo trukmė.
+namespace probes {
+	inline trace::counter
+		text_picks{"picks.text"}, background_picks{"picks.background"},
+		query_ns{"colors.query_ns"}, claim_ns{"colors.claim_ns"};
+	inline trace::histogram nearest_distance{"colors.nearest_distance", true};
+}
+
+// Kurie pikseliai jau užimti šiame paleidime. Pikselis užimtas, jei jo žyma lygi epoch, todėl naujas paleidimas tik padidina
+// epoch ir nei žymų, nei paties paveikslo valyti nereikia – grow() vis tiek perrašo kiekvieną pikselį. Žymos valomos kas 255 paleidimus.
+struct occupancy {
+	aa::fixed_array<uint8_t> stamps;
+	uint8_t epoch = 0;
+
+	explicit occupancy(const size_t size) : stamps{size} {
+		std::ranges::fill(stamps, uint8_t{0});
+	}
+
+	constexpr void restart() & {
+		if (!++epoch) {
+			std::ranges::fill(stamps, uint8_t{0});
+			epoch = 1;
+		}
+	}
+
+	// true, jei pikselis dar nebuvo užimtas.
+	constexpr bool claim(const size_t index) & {
+		return std::exchange(stamps[index], epoch) != epoch;
+	}
+};
+
+// Teksto pikseliai (ne juodi smoke_data pradžioje) po bitą, o ne visa sf::Color kopija, t. y. 32 kartus mažiau atminties.
+struct text_mask {
+	aa::fixed_array<uint64_t> words;
+	bit_mask bits;
+
+	size_t count = 0;
+
+	explicit text_mask(const aa::pmr::fixed_array<sf::Color> & smoke_data) : words{bit_mask::word_count(smoke_data.size())}, bits{words.data()} {
+		bits.clear(smoke_data.size());
+		for (size_t i = 0; i != smoke_data.size(); ++i) {
+			if (smoke_data[i] != sf::Color::Black) {
+				bits.set(i);
+				++count;
+			}
+		}
+	}
+};
+
+// Krašto pikseliai, teksto ir fono atskirai. Teksto pikselis renkamas 10 kartų rečiau nei fono, t. y. taip pat, kaip kai
+// atsitiktinai ištrauktas teksto pikselis būdavo atmetamas su 0.9 tikimybe, tik visada vienu ištraukimu, kad ir koks mišinys.
+struct frontier {
+	static constexpr size_t background_weight = 10;
+
+	aa::fixed_vector<const uint32_t> text, background;
+
+	frontier(const size_t text_count, const size_t background_count) : text{{text_count}}, background{{background_count}} {}
+
+	constexpr bool empty() const & {
+		return text.empty() && background.empty();
+	}
+
+	constexpr size_t size() const & {
+		return text.size() + background.size();
+	}
+
+	constexpr void push(const uint32_t index, const bool is_text) & {
+		(is_text ? text : background).emplace_back(index);
+	}
+
+	// Išima atsitiktinį pikselį. Ištrauktas skaičius parenka ir sąrašą, ir vietą jame.
+	constexpr uint32_t take(rng::stream & rand) & {
+		const size_t background_span = background_weight * background.size(),
+			pick = rand.between(0uz, background_span + text.size() - 1);
+		const bool is_text = pick >= background_span;
+		if (is_text) probes::text_picks.add();
+		else probes::background_picks.add();
+
+		aa::fixed_vector<const uint32_t> & pool = (is_text ? text : background);
+		const uint32_t & entry = pool[is_text ? pick - background_span : pick / background_weight];
+		const uint32_t index = entry;
+		pool.fast_erase(&entry);
+		return index;
+	}
+};
+
+// Vienas paveikslas. Prieš tai kviečiami occupied.restart() ir colors.restart().
+template<class METRIC = metric::srgb>
+constexpr void grow(aa::pmr::fixed_array<sf::Color> & smoke_data, const bit_mask is_text,
+	frontier & neighbors, occupancy & occupied, free_colors<METRIC> & colors, const sf::Vector2u window_size, rng::stream & rand)
+{
+	const trace::scope whole = trace::scope{"grow"};
+	trace::laps chunk = trace::laps{"pixels_64k"};
+	uint32_t claimed = 0;
+
+	do {
+		const size_t index = rand.between(0uz, smoke_data.last_index());
+		if (!is_text.test(index)) {
+			occupied.claim(index);
+			neighbors.push(aa::cast<uint32_t>(index), false);
+			smoke_data[index] = sf::Color{(rand.between(0u, 0x00'FF'FF'FFu) << 8) | 0xFFu};
+			break;
+		}
+	} while (true);
+	do {
+		const uint32_t curr_index = neighbors.take(rand);
+		sf::Color &new_col = smoke_data[curr_index];
+
+		{
+			const uint32_t wanted = new_col.toInteger() >> 8;
+			// Spalvų 2^24, o pikselių mažiau, todėl laisva visada randama.
+			uint32_t found;
+			{
+				const trace::timed phase = trace::timed{probes::query_ns};
+				found = *colors.nearest(wanted);
+			}
+			{
+				const trace::timed phase = trace::timed{probes::claim_ns};
+				new_col = sf::Color{(colors.claim(found) << 8) | 0xFFu};
+			}
+			if constexpr (trace::enabled) probes::nearest_distance.add(metric::squared_distance(
+				METRIC::coordinates(wanted), METRIC::coordinates(new_col.toInteger() >> 8)));
+		}
+
+		const auto find_neighbor = [&](const uint32_t index) -> void {
+			if (!occupied.claim(index)) return;
+			neighbors.push(index, is_text.test(index));
+			smoke_data[index] = new_col;
+		};
+		const sf::Vector2u pos = {curr_index % window_size.x, curr_index / window_size.x};
+		if (pos.x != (window_size.x - 1))	find_neighbor(curr_index + 1);
+		if (pos.y != (window_size.y - 1))	find_neighbor(curr_index + window_size.x);
+		if (pos.x != 0)						find_neighbor(curr_index - 1);
+		if (pos.y != 0)						find_neighbor(curr_index - window_size.x);
+
+		if constexpr (trace::enabled) if (!(++claimed & 0xFF'FFu)) {
+			chunk.lap();
+			trace::sample("frontier", aa::cast<double>(neighbors.size()));
+		}
+	} while (!neighbors.empty());
+}
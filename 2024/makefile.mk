@@ -1,4 +1,4 @@
-TARGETS := main
+TARGETS := main bench
 
 include ~/maker/variables.mk
 
@@ -3,8 +3,12 @@
 #include "../AA/include/AA/metaprogramming/general.hpp"
 #include "../AA/include/AA/container/constified.hpp"
 #include "../AA/include/AA/container/managed.hpp"
-#include "../AA/include/AA/algorithm/arithmetic.hpp"
-#include "../AA/include/AA/container/fixed_vector.hpp"
+#include "../common/random.hpp"
+#include "../common/save_queue.hpp"
+#include "../common/trace.hpp"
+#include "dirty_rows.hpp"
+#include "engine.hpp"
+#include "run_control.hpp"
 #include "utils.hpp"
 
 #include <SDL3/SDL.h>
@@ -13,6 +17,8 @@
 
 #include <cstdio>
 #include <format>
+#include <string>
+#include <vector>
 
 
 
@@ -25,8 +31,30 @@ namespace {
 		static constexpr std::string_view
 			title = "Thank you 2025"sv,
 			display_text = "Ačiū"sv,
-			output_dir = "output/"sv,
-			screenshot_extension = ".jpeg\0"sv;
+			output_dir = "output/"sv;
+
+		// SDL_EVENT_USER kodas, kurį siunčia screenshots rašymo gija. Auginimo gija siunčia 0, o data1 – baigto paleidimo numerį.
+		static constexpr int32_t screenshot_saved = 1;
+
+		// Auginimo gijos stebėtojas: pažymi pakitusias eilutes ir nutraukia auginimą, kai pagrindinė gija jį paleidžia iš naujo ar baigia.
+		struct progress {
+			dirty_rows & dirty;
+			const run_control & control;
+			uint32_t run;
+
+			constexpr void on_pixel(const uint32_t index) const & {
+				dirty.on_pixel(index);
+			}
+
+			constexpr bool interrupted() const & {
+				return control.interrupted(run);
+			}
+		};
+
+		struct screenshot {
+			uint32_t width, height;
+			std::vector<uint32_t> pixels;
+		};
 
 		// Objects destroyed in reverse order of declaration.
 		aa::managed<std::FILE *, std::fclose> log_file;
@@ -35,254 +63,95 @@ namespace {
 		aa::managed<TTF_Font *, TTF_CloseFont> font;
 		aa::managed<SDL_Texture *, SDL_DestroyTexture> texture;
 		aa::managed<SDL_Surface *, SDL_DestroySurface> is_text_srf;
-		aa::shallowly_managed<uint32_t *> pixels;
-		aa::managed<SDL_Semaphore *, SDL_DestroySemaphore> sem_block_thread;
 		aa::shallowly_managed<SDL_Thread *> worker_thread;
 
+		// Abu naudoja tik pagrindinė gija, auginimo gija valdoma per control.
 		bool
 			should_draw = true,
-			should_take_screenshot = false,
 			is_working = true;
 
+		// Paskutinio restart() numeris: senesnių paleidimų pabaigos pranešimai ignoruojami.
+		uint32_t current_run;
+
 		// Ne const, nes potencialiai gali pasikeisti.
-		uint32_t width, height, pixel_count;
-
-		aa::fixed_vector<char> screenshot_name;
-		aa::fixed_vector<uint32_t> neighbors, good_neighbors;
-
-		std::array<bool, aa::representable_values_v<aa::triplet<std::byte>>> color_used;
-
-		// https://oeis.org/A005875
-		static constexpr std::array num_of_ways = std::to_array<size_t>({
-			1, 6, 12, 8, 6, 24, 24, 0, 12, 30, 24, 24, 8, 24, 48, 0, 6, 48, 36, 24, 24, 48, 24
-		});
-		// https://oeis.org/A000378
-		static constexpr std::array sums_of_three_squares = std::to_array<uint32_t>({
-			1, 2, 3, 4, 5, 6, 8, 9, 10, 11, 12, 13, 14, 16, 17, 18, 19, 20, 21, 22
-		});
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[0]]> color_addends_0 = {
-			0x01'00'00, 0xFF'00'00,
-			0x00'01'00, 0x00'FF'00,
-			0x00'00'01, 0x00'00'FF
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[1]]> color_addends_1 = {
-			0x01'01'00, 0x01'FF'00, 0x01'00'01, 0x01'00'FF,
-			0xFF'01'00, 0xFF'FF'00, 0xFF'00'01, 0xFF'00'FF,
-			0x00'01'01, 0x00'01'FF, 0x00'FF'01, 0x00'FF'FF
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[2]]> color_addends_2 = {
-			0x01'01'01, 0x01'FF'01, 0x01'01'FF, 0x01'FF'FF,
-			0xFF'01'01, 0xFF'FF'01, 0xFF'01'FF, 0xFF'FF'FF
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[3]]> color_addends_3 = {
-			0x02'00'00, 0xFE'00'00,
-			0x00'02'00, 0x00'FE'00,
-			0x00'00'02, 0x00'00'FE
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[4]]> color_addends_4 = {
-			0x02'01'00, 0x02'FF'00, 0x02'00'01, 0x02'00'FF, 0x01'FE'00, 0xFF'FE'00, 0x00'FE'01, 0x00'FE'FF,
-			0xFE'01'00, 0xFE'FF'00, 0xFE'00'01, 0xFE'00'FF, 0x01'00'02, 0xFF'00'02, 0x00'01'02, 0x00'FF'02,
-			0x01'02'00, 0xFF'02'00, 0x00'02'01, 0x00'02'FF, 0x01'00'FE, 0xFF'00'FE, 0x00'01'FE, 0x00'FF'FE
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[5]]> color_addends_5 = {
-			0x02'01'01, 0x02'FF'01, 0x02'01'FF, 0x02'FF'FF, 0x01'FE'01, 0xFF'FE'01, 0x01'FE'FF, 0xFF'FE'FF,
-			0xFE'01'01, 0xFE'FF'01, 0xFE'01'FF, 0xFE'FF'FF, 0x01'01'02, 0xFF'01'02, 0x01'FF'02, 0xFF'FF'02,
-			0x01'02'01, 0xFF'02'01, 0x01'02'FF, 0xFF'02'FF, 0x01'01'FE, 0xFF'01'FE, 0x01'FF'FE, 0xFF'FF'FE
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[6]]> color_addends_6 = {
-			0x02'02'00, 0x02'FE'00, 0x02'00'02, 0x02'00'FE,
-			0xFE'02'00, 0xFE'FE'00, 0xFE'00'02, 0xFE'00'FE,
-			0x00'02'02, 0x00'FE'02, 0x00'02'FE, 0x00'FE'FE
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[7]]> color_addends_7 = {
-			0x03'00'00, 0xFD'00'00,
-			0x00'03'00, 0x00'FD'00,
-			0x00'00'03, 0x00'00'FD,
-			0x02'02'01, 0x02'FE'01, 0x02'01'02, 0x02'01'FE, 0x02'02'FF, 0x02'FE'FF, 0x02'FF'02, 0x02'FF'FE,
-			0xFE'02'01, 0xFE'FE'01, 0xFE'01'02, 0xFE'01'FE, 0xFE'02'FF, 0xFE'FE'FF, 0xFE'FF'02, 0xFE'FF'FE,
-			0x01'02'02, 0x01'FE'02, 0x01'02'FE, 0x01'FE'FE, 0xFF'02'02, 0xFF'FE'02, 0xFF'02'FE, 0xFF'FE'FE
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[8]]> color_addends_8 = {
-			0x03'01'00, 0x03'FF'00, 0x03'00'01, 0x03'00'FF, 0x01'FD'00, 0xFF'FD'00, 0x00'FD'01, 0x00'FD'FF,
-			0xFD'01'00, 0xFD'FF'00, 0xFD'00'01, 0xFD'00'FF, 0x01'00'03, 0xFF'00'03, 0x00'01'03, 0x00'FF'03,
-			0x01'03'00, 0xFF'03'00, 0x00'03'01, 0x00'03'FF, 0x01'00'FD, 0xFF'00'FD, 0x00'01'FD, 0x00'FF'FD
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[9]]> color_addends_9 = {
-			0x03'01'01, 0x03'FF'01, 0x03'01'FF, 0x03'FF'FF, 0x01'FD'01, 0xFF'FD'01, 0x01'FD'FF, 0xFF'FD'FF,
-			0xFD'01'01, 0xFD'FF'01, 0xFD'01'FF, 0xFD'FF'FF, 0x01'01'03, 0xFF'01'03, 0x01'FF'03, 0xFF'FF'03,
-			0x01'03'01, 0xFF'03'01, 0x01'03'FF, 0xFF'03'FF, 0x01'01'FD, 0xFF'01'FD, 0x01'FF'FD, 0xFF'FF'FD
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[10]]> color_addends_10 = {
-			0x02'02'02, 0x02'FE'02, 0x02'02'FE, 0x02'FE'FE,
-			0xFE'02'02, 0xFE'FE'02, 0xFE'02'FE, 0xFE'FE'FE,
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[11]]> color_addends_11 = {
-			0x03'02'00, 0x03'FE'00, 0x03'00'02, 0x03'00'FE, 0x02'FD'00, 0xFE'FD'00, 0x00'FD'02, 0x00'FD'FE,
-			0xFD'02'00, 0xFD'FE'00, 0xFD'00'02, 0xFD'00'FE, 0x02'00'03, 0xFE'00'03, 0x00'02'03, 0x00'FE'03,
-			0x02'03'00, 0xFE'03'00, 0x00'03'02, 0x00'03'FE, 0x02'00'FD, 0xFE'00'FD, 0x00'02'FD, 0x00'FE'FD
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[12]]> color_addends_12 = {
-			0x03'02'01, 0x03'FE'01, 0x03'01'02, 0x03'01'FE, 0x03'02'FF, 0x03'FE'FF, 0x03'FF'02, 0x03'FF'FE,
-			0xFD'02'01, 0xFD'FE'01, 0xFD'01'02, 0xFD'01'FE, 0xFD'02'FF, 0xFD'FE'FF, 0xFD'FF'02, 0xFD'FF'FE,
-			0x02'03'01, 0xFE'03'01, 0x01'03'02, 0x01'03'FE, 0x02'03'FF, 0xFE'03'FF, 0xFF'03'02, 0xFF'03'FE,
-			0x02'FD'01, 0xFE'FD'01, 0x01'FD'02, 0x01'FD'FE, 0x02'FD'FF, 0xFE'FD'FF, 0xFF'FD'02, 0xFF'FD'FE,
-			0x02'01'03, 0xFE'01'03, 0x01'02'03, 0x01'FE'03, 0x02'FF'03, 0xFE'FF'03, 0xFF'02'03, 0xFF'FE'03,
-			0x02'01'FD, 0xFE'01'FD, 0x01'02'FD, 0x01'FE'FD, 0x02'FF'FD, 0xFE'FF'FD, 0xFF'02'FD, 0xFF'FE'FD
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[13]]> color_addends_13 = {
-			0x04'00'00, 0xFC'00'00,
-			0x00'04'00, 0x00'FC'00,
-			0x00'00'04, 0x00'00'FC
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[14]]> color_addends_14 = {
-			0x04'01'00, 0xFC'01'00, 0x04'00'01, 0xFC'00'01, 0x04'FF'00, 0xFC'FF'00, 0x04'00'FF, 0xFC'00'FF,
-			0x01'04'00, 0x01'FC'00, 0x00'04'01, 0x00'FC'01, 0xFF'04'00, 0xFF'FC'00, 0x00'04'FF, 0x00'FC'FF,
-			0x01'00'04, 0x01'00'FC, 0x00'01'04, 0x00'01'FC, 0xFF'00'04, 0xFF'00'FC, 0x00'FF'04, 0x00'FF'FC,
-			0x03'02'02, 0x03'02'FE, 0x03'FE'02, 0x03'FE'FE, 0xFD'02'02, 0xFD'02'FE, 0xFD'FE'02, 0xFD'FE'FE,
-			0x02'03'02, 0xFE'03'02, 0x02'03'FE, 0xFE'03'FE, 0x02'FD'02, 0xFE'FD'02, 0x02'FD'FE, 0xFE'FD'FE,
-			0x02'02'03, 0xFE'02'03, 0x02'FE'03, 0xFE'FE'03, 0x02'02'FD, 0xFE'02'FD, 0x02'FE'FD, 0xFE'FE'FD
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[15]]> color_addends_15 = {
-			0x03'03'00, 0x03'FD'00, 0xFD'03'00, 0xFD'FD'00,
-			0x03'00'03, 0x03'00'FD, 0xFD'00'03, 0xFD'00'FD,
-			0x00'03'03, 0x00'03'FD, 0x00'FD'03, 0x00'FD'FD,
-			0x04'01'01, 0x04'FF'01, 0x04'01'FF, 0x04'FF'FF, 0x01'FC'01, 0xFF'FC'01, 0x01'FC'FF, 0xFF'FC'FF,
-			0xFC'01'01, 0xFC'FF'01, 0xFC'01'FF, 0xFC'FF'FF, 0x01'01'04, 0xFF'01'04, 0x01'FF'04, 0xFF'FF'04,
-			0x01'04'01, 0xFF'04'01, 0x01'04'FF, 0xFF'04'FF, 0x01'01'FC, 0xFF'01'FC, 0x01'FF'FC, 0xFF'FF'FC
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[16]]> color_addends_16 = {
-			0x03'03'01, 0x03'FD'01, 0xFD'03'01, 0xFD'FD'01, 0x03'03'FF, 0x03'FD'FF, 0xFD'03'FF, 0xFD'FD'FF,
-			0x03'01'03, 0x03'01'FD, 0xFD'01'03, 0xFD'01'FD, 0x03'FF'03, 0x03'FF'FD, 0xFD'FF'03, 0xFD'FF'FD,
-			0x01'03'03, 0x01'03'FD, 0x01'FD'03, 0x01'FD'FD, 0xFF'03'03, 0xFF'03'FD, 0xFF'FD'03, 0xFF'FD'FD
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[17]]> color_addends_17 = {
-			0x04'02'00, 0x04'FE'00, 0x04'00'02, 0x04'00'FE, 0x02'FC'00, 0xFE'FC'00, 0x00'FC'02, 0x00'FC'FE,
-			0xFC'02'00, 0xFC'FE'00, 0xFC'00'02, 0xFC'00'FE, 0x02'00'04, 0xFE'00'04, 0x00'02'04, 0x00'FE'04,
-			0x02'04'00, 0xFE'04'00, 0x00'04'02, 0x00'04'FE, 0x02'00'FC, 0xFE'00'FC, 0x00'02'FC, 0x00'FE'FC
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[18]]> color_addends_18 = {
-			0x04'02'01, 0x04'FE'01, 0x04'01'02, 0x04'01'FE, 0x02'FC'01, 0xFE'FC'01, 0x01'FC'02, 0x01'FC'FE,
-			0xFC'02'01, 0xFC'FE'01, 0xFC'01'02, 0xFC'01'FE, 0x02'01'04, 0xFE'01'04, 0x01'02'04, 0x01'FE'04,
-			0x02'04'01, 0xFE'04'01, 0x01'04'02, 0x01'04'FE, 0x02'01'FC, 0xFE'01'FC, 0x01'02'FC, 0x01'FE'FC,
-			0x04'02'FF, 0x04'FE'FF, 0x04'FF'02, 0x04'FF'FE, 0x02'FC'FF, 0xFE'FC'FF, 0xFF'FC'02, 0xFF'FC'FE,
-			0xFC'02'FF, 0xFC'FE'FF, 0xFC'FF'02, 0xFC'FF'FE, 0x02'FF'04, 0xFE'FF'04, 0xFF'02'04, 0xFF'FE'04,
-			0x02'04'FF, 0xFE'04'FF, 0xFF'04'02, 0xFF'04'FE, 0x02'FF'FC, 0xFE'FF'FC, 0xFF'02'FC, 0xFF'FE'FC
-		};
-		std::array<uint32_t, num_of_ways[sums_of_three_squares[19]]> color_addends_19 = {
-			0x03'03'02, 0x03'FD'02, 0xFD'03'02, 0xFD'FD'02, 0x03'03'FE, 0x03'FD'FE, 0xFD'03'FE, 0xFD'FD'FE,
-			0x03'02'03, 0x03'02'FD, 0xFD'02'03, 0xFD'02'FD, 0x03'FE'03, 0x03'FE'FD, 0xFD'FE'03, 0xFD'FE'FD,
-			0x02'03'03, 0x02'03'FD, 0x02'FD'03, 0x02'FD'FD, 0xFE'03'03, 0xFE'03'FD, 0xFE'FD'03, 0xFE'FD'FD
-		};
-		const std::array<std::span<uint32_t>, sums_of_three_squares.size()> color_addends_lists = {
-			color_addends_0, color_addends_1, color_addends_2, color_addends_3,
-			color_addends_4, color_addends_5, color_addends_6, color_addends_7,
-			color_addends_8, color_addends_9, color_addends_10, color_addends_11,
-			color_addends_12, color_addends_13, color_addends_14, color_addends_15,
-			color_addends_16, color_addends_17, color_addends_18, color_addends_19
-		};
+		uint32_t width, height;
+
+		// Kiekvienas perpiešimas naudoja kitą seed, bet visa seka priklauso tik nuo pradinio.
+		uint64_t seed;
+
+		// Kita krašto politika (žr. frontier.hpp) auginama viena gija, nes grow_parallel() moka tik klasikinę.
+		basic_engine<classic_frontier> generator;
+		dirty_rows dirty;
+		run_control control;
+		save_queue<screenshot> screenshots;
 
 
 
 		// Member functions
-		constexpr bool validate_data() const & {
-			if (color_addends_lists.size() != sums_of_three_squares.size()) return false;
-
-			return std::ranges::all_of(color_addends_lists | std::views::enumerate, [](const auto p) static -> bool {
-				const auto & [index, color_addends] = p;
-				if (color_addends.size() != num_of_ways[sums_of_three_squares[aa::unsign(index)]]
-					|| color_addends.empty()) return false;
-
-				const auto last = std::ranges::sort(color_addends);
-				if (std::ranges::adjacent_find(color_addends) != last) return false;
-
-				return std::ranges::all_of(color_addends, [&](const uint32_t addend) -> bool {
-					return (
-						aa::pow(aa::unsign(std::abs(aa::sign(aa::cast<uint32_t>(aa::cast<int8_t>(red(addend))))))) +
-						aa::pow(aa::unsign(std::abs(aa::sign(aa::cast<uint32_t>(aa::cast<int8_t>(green(addend))))))) +
-						aa::pow(aa::unsign(std::abs(aa::sign(aa::cast<uint32_t>(aa::cast<int8_t>(blue(addend)))))))
-					) == sums_of_three_squares[aa::unsign(index)];
-				});
-			});
+		// Variklis pikselius laiko plytelėmis, todėl eilutės išdėstomos tiesiai į užrakintą tekstūros sritį. clear – juodos eilutės.
+		constexpr bool upload_rows(const uint32_t first_row, const uint32_t row_count, const bool clear = false) & {
+			void * out;
+			int pitch;
+			if (!SDL_LockTexture(texture, &aa::stay(SDL_Rect{0, aa::sign(first_row), aa::sign(width), aa::sign(row_count)}), &out, &pitch))
+				return false;
+
+			if (clear) {
+				for (uint32_t row = 0; row != row_count; ++row)
+					std::ranges::fill_n(static_cast<uint32_t *>(out) + size_t{row} * aa::unsign(pitch / 4), width, 0u);
+			} else {
+				generator.copy_rows(first_row, row_count, static_cast<uint32_t *>(out), aa::unsign(pitch / 4));
+			}
+			SDL_UnlockTexture(texture);
+			return true;
+		}
+
+		// Kopija iš variklio buferio be GPU nuskaitymo, koduojama ir rašoma screenshots gijoje. lossless – PNG, kitaip JPEG.
+		constexpr bool save_screenshot(const bool lossless) & {
+			const std::optional d = get_current_date();
+			if (!d) return false;
+
+			screenshot s = {width, height, std::vector<uint32_t>(size_t{width} * height)};
+			generator.copy_rows(0, height, s.pixels.data(), width);
+			screenshots.push(std::move(s), std::format("{}img_{}-{:02}-{:02}_{:02}'{:02}'{:02}.{}", output_dir,
+				d->year, d->month, d->day, d->hour, d->minute, d->second, (lossless ? "png"sv : "jpeg"sv)));
+			return true;
 		}
 
 		constexpr int work() & {
 			// return 0;
 			SDL_Event event = {.type = SDL_RegisterEvents(1)};
 
-			const uint8_t * const is_text = std::bit_cast<uint8_t *>(is_text_srf->pixels);
-
-			// std::println("pixel format: {:x}. pitch: {}", std::to_underlying(texture->format), pixels_srf->pitch);
+			const uint32_t thread_count = aa::unsign(SDL_GetNumLogicalCPUCores());
 
-			do {
-				std::ranges::fill_n(pixels.get(), pixel_count, 0u);
-				std::ranges::fill(color_used, false);
-
-				{
-					const uint32_t first_index = random(pixel_count);
-					neighbors.emplace_back(first_index);
-					pixels[first_index] = 0xFF'00'00'00u | random(0x01'00'00'00u);
+			// Nutrauktas paleidimas nepraneša apie pabaigą: pagrindinė gija jau laukia kito.
+			uint32_t run = 0;
+			while (const std::optional run_seed = control.wait_for_run(run)) {
+				if constexpr (decltype(generator)::is_parallel) {
+					if (!generator.grow_parallel(thread_count, *run_seed, progress{dirty, control, run})) continue;
+				} else {
+					if (!generator.grow(*run_seed, progress{dirty, control, run})) continue;
 				}
-				do {
-					aa::fixed_vector<uint32_t> & curr_neighbors =
-						(neighbors.empty() || (!good_neighbors.empty() && SDL_randf() < 0.0001f))
-						? good_neighbors : neighbors;
-
-					const uint32_t & curr_index = curr_neighbors[random(curr_neighbors.size())];
-					uint32_t & curr_color = pixels[curr_index];
-
-					// Find nearest color
-					std::ranges::any_of(std::views::iota(1u), [&](const uint32_t extent) -> bool {
-						return std::ranges::any_of(color_addends_lists, [&](const std::span<uint32_t> color_addends) -> bool {
-							return std::ranges::any_of(color_addends, [&](uint32_t & addend) -> bool {
-								std::ranges::swap(addend, (&addend)[random(std::to_address(color_addends.end()) - &addend)]);
-
-								const uint32_t r = red(curr_color) + (extent * aa::cast<uint32_t>(aa::cast<int8_t>(red(addend))));
-								if (r > 0xFFu) return false;
-								const uint32_t g = green(curr_color) + (extent * aa::cast<uint32_t>(aa::cast<int8_t>(green(addend))));
-								if (g > 0xFFu) return false;
-								const uint32_t b = blue(curr_color) + (extent * aa::cast<uint32_t>(aa::cast<int8_t>(blue(addend))));
-								if (b > 0xFFu) return false;
-
-								const uint32_t new_col = ((r << 16) | (g << 8) | (b << 0));
-								if (color_used[new_col]) {
-									return false;
-								} else {
-									curr_color = 0xFF'00'00'00u | new_col;
-									color_used[new_col] = true;
-									return true;
-								}
-							});
-						});
-					});
-
-					// Find neighbors
-					const auto find_neighbor = [&](const uint32_t new_index) -> void {
-						if (pixels[new_index]) return;
-						((is_text[curr_index] != is_text[new_index]) ? good_neighbors : neighbors).emplace_back(new_index);
-						pixels[new_index] = curr_color;
-					};
-					const auto [pos_x, pos_y] = aa::pair{curr_index % width, curr_index / width};
-					if /**/ (pos_x == (width - 1))				find_neighbor(curr_index - 1);
-					else if (pos_x == 0)						find_neighbor(curr_index + 1);
-					else [[likely]] { find_neighbor(curr_index - 1);		find_neighbor(curr_index + 1); }
-					if /**/ (pos_y == (height - 1))				find_neighbor(curr_index - width);
-					else if (pos_y == 0)						find_neighbor(curr_index + width);
-					else [[likely]] { find_neighbor(curr_index - width);	find_neighbor(curr_index + width); }
-
-
-					curr_neighbors.fast_pop(const_cast<uint32_t *>(&curr_index));
-				} while (!neighbors.empty() || !good_neighbors.empty());
 
 				// Stop working
+				event.user.data1 = std::bit_cast<void *>(uintptr_t{run});
 				E(SDL_PushEvent(&event));
-				SDL_WaitSemaphore(sem_block_thread);
-			} while (is_working);
+			}
 
 			return EXIT_SUCCESS;
 		}
 
+		// Išvalo ekraną ir nedelsdamas paleidžia auginimą iš naujo, nutraukdamas vykstantį.
+		constexpr bool restart() & {
+			is_working = true;
+			current_run = control.restart(seed++);
+			dirty.consume([](const uint32_t, const uint32_t) static -> void {});
+			if (!upload_rows(0, height, true)) return false;
+			return SDL_SetHint(SDL_HINT_MAIN_CALLBACK_RATE, "0");
+		}
+
 	public:
-		constexpr SDL_AppResult init(const int argc, const char * const * const) & {
+		// Usage: main [seed]. Be seed imamas laikrodis.
+		constexpr SDL_AppResult init(const int argc, const char * const * const argv) & {
 			// Negalime naudoti SDL numatytos funkcijos, nes ji labai neoptimali ir neišvengiamai spausdina \r\n.
 			// Negalime rašyti į failo galą, nes tada reiktų failo valymo strategijos.
 			E<error_kind::bad_log>(log_file = std::freopen("SDL_Log.log", "wb", stdout));
@@ -292,14 +161,14 @@ namespace {
 				E(false, c, p, m);
 			}, nullptr);
 
-			E<error_kind::bad_argv>(argc == 1);
+			E<error_kind::bad_argv>(argc <= 2);
 			// E<error_kind::info>(false);
-
-			if (E<error_kind::bad_data>(validate_data())) return SDL_APP_FAILURE;
+			seed = rng::parse_seed((argc == 2) ? std::optional<std::string_view>{argv[1]} : std::nullopt);
 
 
 			if (E(SDL_SetHint(SDL_HINT_RENDER_DRIVER, "vulkan")))			return SDL_APP_FAILURE;
-			if (E(SDL_SetHint(SDL_HINT_MAIN_CALLBACK_RATE, "waitevent")))	return SDL_APP_FAILURE;
+			// Kol gija dirba, iterate() kviečiamas kiekvienam kadrui, kad būtų matyti augimas.
+			if (E(SDL_SetHint(SDL_HINT_MAIN_CALLBACK_RATE, "0")))			return SDL_APP_FAILURE;
 
 			if (E(SDL_SetAppMetadataProperty(SDL_PROP_APP_METADATA_NAME_STRING, title.data())))	return SDL_APP_FAILURE;
 			if (E(SDL_SetAppMetadataProperty(SDL_PROP_APP_METADATA_VERSION_STRING, "1.0")))		return SDL_APP_FAILURE;
@@ -311,13 +180,13 @@ namespace {
 
 			if (E(SDL_CreateWindowAndRenderer(title.data(), 0, 0, SDL_WINDOW_FULLSCREEN, &window.acquire(), &renderer.acquire())))
 				return SDL_APP_FAILURE;
+			E(SDL_SetRenderVSync(renderer, 1));
 
 
 			if (E(SDL_GetWindowSizeInPixels(window, std::bit_cast<int *>(&width), std::bit_cast<int *>(&height))))
 				return SDL_APP_FAILURE;
-			pixel_count = width * height;
 
-			if (E(texture = SDL_CreateTexture(renderer, SDL_PixelFormat::SDL_PIXELFORMAT_UNKNOWN,
+			if (E(texture = SDL_CreateTexture(renderer, SDL_PixelFormat::SDL_PIXELFORMAT_ARGB8888,
 				SDL_TextureAccess::SDL_TEXTUREACCESS_STREAMING, aa::sign(width), aa::sign(height)))
 			) return SDL_APP_FAILURE;
 
@@ -345,18 +214,16 @@ namespace {
 			if (E((is_text_srf = SDL_ConvertSurface(pixels_srf, SDL_PixelFormat::SDL_PIXELFORMAT_RGB332)).has_ownership()))
 				return SDL_APP_FAILURE;
 
-			// Be šitų eilučių Segmentation fault.
 			SDL_UnlockTexture(texture);
-			if (E(SDL_LockTexture(texture, nullptr, std::bit_cast<void **>(&pixels.acquire()), &aa::stay<int>())))
-				return SDL_APP_FAILURE;
 
+			// Gija auga į variklio buferį, o į tekstūrą keliamos tik pakitusios eilutės.
+			if (E(dirty.init(width, height))) return SDL_APP_FAILURE;
 
-			if (E((neighbors = {{pixel_count}}).has_ownership())) return SDL_APP_FAILURE;
-			if (E((good_neighbors = {{pixel_count}}).has_ownership())) return SDL_APP_FAILURE;
 
-			if (E(sem_block_thread = SDL_CreateSemaphore(0)))
+			if (E(generator.init(width, height, std::bit_cast<uint8_t *>(is_text_srf->pixels), aa::unsign(is_text_srf->pitch))))
 				return SDL_APP_FAILURE;
 
+			current_run = control.restart(seed++);
 			if (E(worker_thread = SDL_CreateThread([](void * const appstate) static -> int {
 				return std::bit_cast<application *>(appstate)->work();
 			}, "worker_thread", this)))
@@ -364,7 +231,15 @@ namespace {
 
 
 			if (E(SDL_CreateDirectory(output_dir.data()))) return SDL_APP_FAILURE;
-			if (E((screenshot_name = {100 + output_dir.size(), output_dir}).has_ownership())) return SDL_APP_FAILURE;
+			screenshots.start([](const screenshot & s, const std::string & path) static -> bool {
+				const aa::managed<SDL_Surface *, SDL_DestroySurface> surface = SDL_CreateSurfaceFrom(aa::sign(s.width), aa::sign(s.height),
+					SDL_PixelFormat::SDL_PIXELFORMAT_ARGB8888, const_cast<uint32_t *>(s.pixels.data()), aa::sign(s.width * 4u));
+				if (!surface.has_ownership()) return false;
+				return (path.ends_with(".png") ? IMG_SavePNG(surface, path.data()) : IMG_SaveJPG(surface, path.data(), 100));
+			}, [](void * const) static -> void {
+				SDL_Event event = {.user = {.type = SDL_EventType::SDL_EVENT_USER, .code = screenshot_saved}};
+				E(SDL_PushEvent(&event));
+			});
 
 			// Reikia šito kitaip teksto nenupiešia, nupiešia tik foną.
 			// E(SDL_RenderPresent(renderer));
@@ -388,28 +263,39 @@ namespace {
 					break;
 
 				case SDLK_S:
-					if (!event.key.repeat && (event.key.mod & SDL_KMOD_CTRL)) {
-						should_draw = true;
-						should_take_screenshot = true;
-					}
+					// Ctrl+Shift+S – be nuostolių.
+					if (!event.key.repeat && (event.key.mod & SDL_KMOD_CTRL))
+						E(save_screenshot(event.key.mod & SDL_KMOD_SHIFT));
 					break;
 
 				case SDLK_R:
-					if (!is_working && !event.key.repeat) {
-						is_working = true;
-						if (E(SDL_LockTexture(texture, nullptr, std::bit_cast<void **>(&pixels.acquire()), &aa::stay<int>())))
-							return SDL_APP_FAILURE;
+					// Ir auginimo metu: jis nutraukiamas per kelias milisekundes.
+					if (!event.key.repeat && E(restart())) return SDL_APP_FAILURE;
+					break;
 
-						SDL_SignalSemaphore(sem_block_thread);
+				case SDLK_P:
+					// Kol pristabdyta, kadrai nebereikalingi.
+					if (is_working && !event.key.repeat) {
+						control.toggle_pause();
+						if (E(SDL_SetHint(SDL_HINT_MAIN_CALLBACK_RATE, (control.is_paused() ? "waitevent" : "0")))) return SDL_APP_FAILURE;
 					}
 					break;
 				}
 				break;
 
 			case SDL_EventType::SDL_EVENT_USER:
+				if (event.user.code == screenshot_saved) {
+					screenshots.consume([](const std::string & path, const bool ok) static -> void {
+						E<error_kind::bad_file>(ok, SDL_LogCategory::SDL_LOG_CATEGORY_APPLICATION, SDL_LogPriority::SDL_LOG_PRIORITY_ERROR, path.data());
+					});
+					break;
+				}
+				if (std::bit_cast<uintptr_t>(event.user.data1) != current_run) break;
 				should_draw = true;
 				is_working = false;
-				SDL_UnlockTexture(texture);
+				dirty.consume([](const uint32_t, const uint32_t) static -> void {});
+				if (E(upload_rows(0, height))) return SDL_APP_FAILURE;
+				if (E(SDL_SetHint(SDL_HINT_MAIN_CALLBACK_RATE, "waitevent"))) return SDL_APP_FAILURE;
 				break;
 			}
 
@@ -417,42 +303,34 @@ namespace {
 		}
 
 		constexpr SDL_AppResult iterate() & {
+			if (is_working) {
+				// Progressive preview
+				dirty.consume([&](const uint32_t first_row, const uint32_t row_count) -> void {
+					E(upload_rows(first_row, row_count));
+				});
+				should_draw = true;
+			}
+
 			if (std::exchange(should_draw, false)) {
 				// Draw
 				E(SDL_RenderTexture(renderer, texture, nullptr, nullptr));
-
-
-				switch (std::exchange(should_take_screenshot, false)) {
-				case true:
-					const SDL_DateTime d = get_current_date().value_or(aa::default_value);
-
-					auto [out, _] = std::format_to_n(
-						const_cast<char *>(screenshot_name.end()), aa::sign(screenshot_name.space() - screenshot_extension.size()),
-						"img_{}-{:02}-{:02}_{:02}'{:02}'{:02}", d.year, d.month, d.day, d.hour, d.minute, d.second);
-					std::ranges::copy(screenshot_extension, out);
-
-					// https://gigi.nullneuron.net/gigilabs/saving-screenshots-in-sdl2/
-					const aa::managed<SDL_Surface *, SDL_DestroySurface> screenshot = SDL_RenderReadPixels(renderer, nullptr);
-					if (E(screenshot.has_ownership())) break;
-					E(IMG_SaveJPG(screenshot, std::as_const(screenshot_name).data(), 100));
-				}
-
-
 				E(SDL_RenderPresent(renderer));
 			}
 			return SDL_APP_CONTINUE;
 		}
 
 		constexpr SDL_AppResult quit() & {
+			// Laukiančios nuotraukos įrašomos, kol SDL dar veikia.
+			screenshots.finish();
 			if (worker_thread.has_ownership()) {
-				is_working = false;
-				SDL_SignalSemaphore(sem_block_thread);
+				control.quit();
 				if (E<error_kind::bad_thread>(!aa::make([&](int & status) -> void {
 					SDL_WaitThread(worker_thread, &status);
 				})))
 					return SDL_APP_FAILURE;
 			}
-			// E<error_kind::bad_data>(validate_data());
+			// Tik kompiliuojant su TRACE, kai variklio gija jau baigta.
+			if (E<error_kind::bad_file>(trace::finish("output/trace.json"))) return SDL_APP_FAILURE;
 			return SDL_APP_SUCCESS;
 		}
 	};
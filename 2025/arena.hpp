@@ -0,0 +1,95 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+
+
+namespace {
+	// Vienas ištisinis blokas visiems vieno paleidimo buferiams. Linux'e pirmiau bandomi aiškūs dideli puslapiai
+	// (MAP_HUGETLB), tada skaidrūs (MADV_HUGEPAGE), kitur – paprasta, puslapiu sulygiuota atmintis.
+	// Buferiai išduodami didinant poslinkį ir atskirai neatlaisvinami.
+	struct arena {
+		// Member objects
+	private:
+		static constexpr size_t huge_page_size = 2uz << 20, line_size = 64;
+
+		std::byte * base = nullptr;
+		size_t capacity = 0, used = 0;
+		bool explicit_huge = false, mapped = false;
+
+
+
+		// Member functions
+		constexpr void release() & {
+			if (!base) return;
+#ifdef __linux__
+			if (mapped) munmap(base, capacity);
+			else
+#endif
+			::operator delete(base, std::align_val_t{huge_page_size});
+			base = nullptr;
+			capacity = used = 0;
+		}
+
+	public:
+		constexpr arena() = default;
+		arena(const arena &) = delete;
+		arena & operator=(const arena &) = delete;
+		constexpr ~arena() { release(); }
+
+		// Sunaikina ankstesnį bloką ir rezervuoja naują, ne mažesnį nei bytes.
+		constexpr bool reserve(const size_t bytes) & {
+			release();
+			capacity = (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+			explicit_huge = mapped = false;
+#ifdef __linux__
+			if (void * const p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0); p != MAP_FAILED) {
+				base = static_cast<std::byte *>(p);
+				explicit_huge = mapped = true;
+				return true;
+			}
+			if (void * const p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); p != MAP_FAILED) {
+				base = static_cast<std::byte *>(p);
+				mapped = true;
+				madvise(base, capacity, MADV_HUGEPAGE);
+				return true;
+			}
+#endif
+			base = static_cast<std::byte *>(::operator new(capacity, std::align_val_t{huge_page_size}, std::nothrow));
+			return base != nullptr;
+		}
+
+		// Vietos count objektams T, sulygiuotos bent iki spartinančiosios atminties eilutės. Objektai nekonstruojami.
+		template<class T>
+		constexpr T * allocate(const size_t count) & {
+			static constexpr size_t alignment = std::ranges::max(alignof(T), line_size);
+			const size_t offset = (used + alignment - 1) / alignment * alignment;
+			if (offset + sizeof(T) * count > capacity) return nullptr;
+			used = offset + sizeof(T) * count;
+			return std::bit_cast<T *>(base + offset);
+		}
+
+		// Kiek baitų reikia count objektų T, įskaitant lygiavimą. Naudojama apskaičiuoti reserve dydį.
+		template<class T>
+		static constexpr size_t footprint(const size_t count) {
+			return sizeof(T) * count + std::ranges::max(alignof(T), line_size);
+		}
+
+		// Visi išduoti buferiai tampa nebegaliojantys, blokas lieka rezervuotas.
+		constexpr void reset() & {
+			used = 0;
+		}
+
+		constexpr bool has_explicit_huge_pages() const & { return explicit_huge; }
+	};
+}
@@ -0,0 +1,72 @@
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../common/bench.hpp"
+#include "../common/trace.hpp"
+#include "engine.hpp"
+#include "utils.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+
+
+// Matuoja engine::grow ir engine::grow_parallel be lango, taip pat grow su kiekviena krašto politika ir metrika.
+// Krašto politika ir metrika parenkamos kompiliuojant, todėl kiekvienam deriniui kuriamas atskiras variklis. Jis sunaikinamas
+// prieš kitą įrašą, kad peak_rss_bytes rodytų tik jo atmintį.
+int main(const int argc, char ** const argv) {
+	const uint32_t thread_count = aa::unsign(SDL_GetNumLogicalCPUCores());
+
+	const int status = bench::run(argc, argv, [&](bench::report & out, const bench::resolution & r, const uint64_t seed) -> void {
+		bench::stopwatch watch;
+
+		const std::unique_ptr mask = std::make_unique_for_overwrite<uint8_t[]>(size_t{r.width} * r.height);
+		for (uint32_t y = 0; y != r.height; ++y) {
+			for (uint32_t x = 0; x != r.width; ++x) {
+				mask[size_t{y} * r.width + x] = aa::cast<uint8_t>(bench::in_mask(x, y, r.width, r.height) ? 0xFFu : 0u);
+			}
+		}
+
+		{
+			watch.lap();
+			const std::unique_ptr generator = std::make_unique<engine>();
+			if (E(generator->init(r.width, r.height, mask.get(), r.width))) return;
+			const double init = watch.lap();
+
+			generator->grow(seed);
+			const double grow = watch.lap();
+			out.record("2025", "grow", r, seed, {{"init", init}, {"grow", grow}},
+				{{"pixels_per_second", generator->get_pixel_count() / grow}});
+
+			watch.lap();
+			generator->grow_parallel(thread_count, seed);
+			const double grow_parallel = watch.lap();
+			out.record("2025", "grow_parallel", r, seed, {{"init", init}, {"grow", grow_parallel}},
+				{{"pixels_per_second", generator->get_pixel_count() / grow_parallel}, {"threads", aa::cast<double>(thread_count)}});
+		}
+
+		const auto grow_with = [&]<class G>(const std::type_identity<G>, const std::string_view kernel) -> void {
+			watch.lap();
+			const std::unique_ptr policy_generator = std::make_unique<G>();
+			if (E(policy_generator->init(r.width, r.height, mask.get(), r.width))) return;
+			const double policy_init = watch.lap();
+
+			policy_generator->grow(seed);
+			const double policy_grow = watch.lap();
+			out.record("2025", kernel, r, seed, {{"init", policy_init}, {"grow", policy_grow}},
+				{{"pixels_per_second", policy_generator->get_pixel_count() / policy_grow}});
+		};
+		grow_with(std::type_identity<basic_engine<fifo_frontier>>{}, "grow_fifo");
+		grow_with(std::type_identity<basic_engine<lifo_frontier>>{}, "grow_lifo");
+		grow_with(std::type_identity<basic_engine<boundary_frontier<>>>{}, "grow_boundary");
+		grow_with(std::type_identity<basic_engine<age_frontier<true>>>{}, "grow_age_old");
+		grow_with(std::type_identity<basic_engine<age_frontier<false>>>{}, "grow_age_young");
+		grow_with(std::type_identity<basic_engine<classic_frontier, 48, metric::weighted<2, 3, 1>>>{}, "grow_weighted");
+		grow_with(std::type_identity<basic_engine<classic_frontier, 48, metric::linear>>{}, "grow_linear");
+		grow_with(std::type_identity<basic_engine<classic_frontier, 48, metric::oklab>>{}, "grow_oklab");
+	});
+	// JSON ataskaita eina į stdout, todėl suvestinė – į stderr.
+	trace::finish("trace.json", stderr);
+	return status;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../common/random.hpp"
+#include "../common/mapped_file.hpp"
+#include "tiled_layout.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <optional>
+
+
+
+namespace {
+	// Nuosekliojo auginimo būsena be buferių. done ir frontier_size – tik pažangai ir profiliavimui.
+	struct growth_state {
+		rng::stream stream = rng::stream{0};
+		uint32_t done, frontier_size;
+	};
+
+	struct checkpoint_slot {
+		// 0 – lizdas dar neįrašytas. Galioja lizdas su didesniu numeriu.
+		uint64_t sequence, state_bytes;
+		growth_state state;
+	};
+
+	// Kontrolinio taško failo pradžia. Po jos, nuo page_size, eina du po slot_bytes dydžio lizdai: pikseliai tiled_layout tvarka
+	// (su rėmu), o nuo puslapio ribos – likusios būsenos sritys (stamp, spalvų aibės, krašto kiekiai ir buferiai) be tarpų.
+	// Likę laukai turi sutapti su varikliu, kuris failą atidaro.
+	struct checkpoint_header {
+		std::array<char, 8> magic = {'A', 'A', 'C', 'K', 'P', 'T', '0', '3'};
+		uint32_t width, height;
+		uint64_t mask_hash, frontier_policy, frontier_footprint, state_capacity, slot_bytes;
+		std::array<checkpoint_slot, 2> slots;
+	};
+
+	// Periodiniai auginimo kontroliniai taškai atmintyje atvaizduotame faile. Rašoma į senesnį lizdą ir tik po to
+	// atnaujinamas jo aprašas, todėl nutraukus rašymą lieka ankstesnis pilnas taškas. Pikselių puslapiai kopijuojami tik
+	// jei pasikeitė nuo paskutinio įrašo į tą lizdą (žr. touch), likusios sritys – tik pasikeitę failo puslapiai.
+	struct checkpoint_file {
+		// Member objects
+	private:
+		static constexpr size_t page_size = 4096, page_pixels = page_size / sizeof(uint32_t);
+
+		mapped_file file;
+		// Kiekvienam pikselių puslapiui bitas s reiškia, kad lizde s jis pasenęs.
+		std::unique_ptr<uint8_t[]> stale;
+		size_t pixel_bytes, pixel_area;
+		uint32_t page_count;
+
+		constexpr checkpoint_header & header() const & { return *std::bit_cast<checkpoint_header *>(file.data()); }
+		constexpr std::byte * slot(const size_t s) const & { return file.data() + page_size + s * header().slot_bytes; }
+
+		static constexpr size_t round_up(const size_t bytes) {
+			return (bytes + page_size - 1) / page_size * page_size;
+		}
+
+		// Nepasikeitę puslapiai nerašomi, kad nepasidarytų nešvarūs ir OS jų nerašytų į diską.
+		static constexpr void store(std::byte * const to, const std::byte * const from, const size_t bytes) {
+			for (size_t offset = 0; offset < bytes; offset += page_size) {
+				const size_t size = std::ranges::min(page_size, bytes - offset);
+				if (std::memcmp(to + offset, from + offset, size)) std::memcpy(to + offset, from + offset, size);
+			}
+		}
+
+		constexpr void init(const tiled_layout & layout) & {
+			pixel_bytes = size_t{layout.size()} * sizeof(uint32_t);
+			pixel_area = round_up(pixel_bytes);
+			page_count = aa::cast<uint32_t>(pixel_area / page_size);
+		}
+
+
+
+		// Member functions
+	public:
+		// identity – matmenys, kaukės parašas, krašto politika ir dydis bei state_capacity, t. y. kiek daugiausiai baitų užima būsenos sritys.
+		constexpr bool create(const char * const path, const tiled_layout & layout, const checkpoint_header & identity) & {
+			init(layout);
+			const size_t slot_bytes = pixel_area + round_up(identity.state_capacity);
+			if (!file.open(path, page_size + 2 * slot_bytes, false)) return false;
+
+			std::ranges::construct_at(&header(), identity)->slot_bytes = slot_bytes;
+			stale = std::make_unique_for_overwrite<uint8_t[]>(page_count);
+			std::ranges::fill_n(stale.get(), page_count, uint8_t{0b11});
+			return file.flush();
+		}
+
+		// Esamas failas, kurio antraštė sutampa su identity.
+		constexpr bool open(const char * const path, const tiled_layout & layout, const checkpoint_header & identity) & {
+			init(layout);
+			const size_t slot_bytes = pixel_area + round_up(identity.state_capacity);
+			if (!file.open_existing(path) || file.get_size() < page_size + 2 * slot_bytes) return false;
+
+			const checkpoint_header & h = header();
+			if (h.magic != identity.magic || h.width != identity.width || h.height != identity.height || h.mask_hash != identity.mask_hash
+				|| h.frontier_policy != identity.frontier_policy || h.frontier_footprint != identity.frontier_footprint
+				|| h.state_capacity != identity.state_capacity || h.slot_bytes != slot_bytes) return false;
+
+			stale = std::make_unique_for_overwrite<uint8_t[]>(page_count);
+			return true;
+		}
+
+		// Pikselis index (tiled_layout) pakeistas.
+		constexpr void touch(const uint32_t index) & {
+			stale[index / page_pixels] = 0b11;
+		}
+
+		// regions(f) kviečia f(data, count) kiekvienai būsenos sričiai, kaip frontier visit_state.
+		template<class V>
+		constexpr bool save(const uint32_t * const pixels, V && regions, const growth_state & state) & {
+			checkpoint_header & h = header();
+			const size_t s = ((h.slots[0].sequence <= h.slots[1].sequence) ? 0 : 1);
+			const uint8_t bit = aa::cast<uint8_t>(1u << s);
+			std::byte * const to = slot(s);
+
+			for (uint32_t page = 0; page != page_count; ++page) {
+				if (!(stale[page] & bit)) continue;
+				stale[page] &= aa::cast<uint8_t>(~bit);
+				const size_t offset = size_t{page} * page_size;
+				std::memcpy(to + offset, pixels + size_t{page} * page_pixels, std::ranges::min(page_size, pixel_bytes - offset));
+			}
+
+			size_t used = 0;
+			bool fits = true;
+			regions([&]<class T>(const T * const data, const size_t count) -> void {
+				const size_t bytes = sizeof(T) * count;
+				if (!(fits &= (used + bytes <= h.state_capacity))) return;
+				store(to + pixel_area + used, std::bit_cast<const std::byte *>(data), bytes);
+				used += bytes;
+			});
+			// Išrašomas tik šis lizdas, o po jo – antraštės puslapis, kad antraštė niekada nerodytų į neišrašytą lizdą.
+			if (!fits || !file.flush(page_size + s * h.slot_bytes, pixel_area + used)) return false;
+
+			h.slots[s] = {std::ranges::max(h.slots[0].sequence, h.slots[1].sequence) + 1, used, state};
+			return file.flush(0, page_size);
+		}
+
+		// Ar įrašytas bent vienas taškas, t. y. ar load() turi ką atkurti.
+		constexpr bool has_slot() const & {
+			const checkpoint_header & h = header();
+			return std::ranges::any_of(h.slots, [&](const checkpoint_slot & slot) -> bool {
+				return slot.sequence && slot.state_bytes <= h.state_capacity;
+			});
+		}
+
+		// Naujausias įrašytas taškas. Po jo kitas save() rašo į kitą lizdą, todėl ten perrašomi visi pikseliai.
+		template<class V>
+		constexpr std::optional<growth_state> load(uint32_t * const pixels, V && regions) & {
+			const checkpoint_header & h = header();
+			const size_t s = ((h.slots[0].sequence > h.slots[1].sequence) ? 0 : 1);
+			if (!h.slots[s].sequence || h.slots[s].state_bytes > h.state_capacity) return std::nullopt;
+			const std::byte * const from = slot(s);
+
+			std::memcpy(pixels, from, pixel_bytes);
+			size_t used = 0;
+			bool fits = true;
+			regions([&]<class T>(T * const data, const size_t count) -> void {
+				const size_t bytes = sizeof(T) * count;
+				if (!(fits &= (used + bytes <= h.slots[s].state_bytes))) return;
+				std::memcpy(data, from + pixel_area + used, bytes);
+				used += bytes;
+			});
+			if (!fits || used != h.slots[s].state_bytes) return std::nullopt;
+
+			std::ranges::fill_n(stale.get(), page_count, aa::cast<uint8_t>(1u << (1 - s)));
+			return h.slots[s].state;
+		}
+	};
+}
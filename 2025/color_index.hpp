@@ -0,0 +1,150 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../common/color_metric.hpp"
+#include "utils.hpp"
+
+#include <atomic>
+#include <bit>
+
+
+
+namespace {
+	// Laisvų spalvų piramidė RGB kubui. Lygyje L kubas padalintas į 8^L vienodų kubelių ir kiekvienam
+	// saugomas jame likusių laisvų spalvų skaičius. Paskutinis lygis (kubeliai 2x2x2) saugo laisvų spalvų kaukę.
+	// Artimiausia spalva ieškoma pagal METRIC (žr. color_metric.hpp), kubeliai atmetami pagal jos box_distance.
+	template<class METRIC = metric::srgb>
+	struct color_index {
+		// Member objects
+	private:
+		static constexpr uint32_t depth = 7, shared_level = 3;
+
+		static constexpr uint32_t offset(const uint32_t level) {
+			return ((1u << (3 * level)) - 1) / 7;
+		}
+
+		static constexpr uint32_t node(const uint32_t level, const uint32_t x, const uint32_t y, const uint32_t z) {
+			return ((x << (2 * level)) | (y << level) | z);
+		}
+
+		std::array<uint32_t, ((1uz << (3 * depth)) - 1) / 7> counts;
+		std::array<uint8_t, 1uz << (3 * depth)> cells;
+
+		struct query {
+			metric::point target;
+			uint32_t best_distance, best_color, ties;
+		};
+
+
+
+		// Member functions
+		template<bool SHARED, uint32_t L>
+		constexpr uint32_t count(const uint32_t x, const uint32_t y, const uint32_t z) const & {
+			if constexpr (L == depth)	return aa::cast<uint32_t>(std::popcount(shared_load<SHARED>(cells[node(depth, x, y, z)])));
+			else						return shared_load<SHARED>(counts[offset(L) + node(L, x, y, z)]);
+		}
+
+		template<class R>
+		constexpr void consider(query & q, const uint32_t color, R & rand) const & {
+			const uint32_t distance = metric::squared_distance(q.target, METRIC::coordinates(color));
+			if (distance < q.best_distance) {
+				q.best_distance = distance;
+				q.best_color = color;
+				q.ties = 1;
+			} else if (distance == q.best_distance && !rand(++q.ties)) {
+				q.best_color = color;
+			}
+		}
+
+		// Lankome vaikus didėjančio atstumo tvarka ir nukertame tuos, kurie toliau už geriausią rastą spalvą.
+		template<bool SHARED, uint32_t L, class R>
+		constexpr void search(query & q, const uint32_t x, const uint32_t y, const uint32_t z, R & rand) const & {
+			if constexpr (L == depth) {
+				for (uint32_t mask = shared_load<SHARED>(cells[node(depth, x, y, z)]); mask; mask &= mask - 1) {
+					const uint32_t i = aa::cast<uint32_t>(std::countr_zero(mask));
+					consider(q, ((((x << 1) | (i >> 2)) << 16) | (((y << 1) | ((i >> 1) & 1)) << 8) | ((z << 1) | (i & 1))), rand);
+				}
+			} else {
+				static constexpr uint32_t side = 0x100u >> (L + 1);
+
+				std::array<std::pair<uint32_t, uint32_t>, 8> children;
+				size_t size = 0;
+				for (uint32_t i = 0; i != 8; ++i) {
+					const uint32_t cx = (x << 1) | (i >> 2), cy = (y << 1) | ((i >> 1) & 1), cz = (z << 1) | (i & 1);
+					if (!count<SHARED, L + 1>(cx, cy, cz)) continue;
+
+					const uint32_t lo = ((cx * side) << 16) | ((cy * side) << 8) | (cz * side);
+					const std::pair<uint32_t, uint32_t> child = {METRIC::box_distance(q.target, lo, lo + (side - 1) * 0x01'01'01u), i};
+					size_t j = size++;
+					for (; j && children[j - 1].first > child.first; --j) children[j] = children[j - 1];
+					children[j] = child;
+				}
+
+				for (const auto & [distance, i] : std::span{children.data(), size}) {
+					if (distance > q.best_distance) break;
+					search<SHARED, L + 1>(q, (x << 1) | (i >> 2), (y << 1) | ((i >> 1) & 1), (z << 1) | (i & 1), rand);
+				}
+			}
+		}
+
+	public:
+		constexpr void reset() & {
+			for (uint32_t level = 0; level != depth; ++level) {
+				std::ranges::fill(std::span{counts.data() + offset(level), counts.data() + offset(level + 1)},
+					1u << (3 * (8 - level)));
+			}
+			std::ranges::fill(cells, uint8_t{0xFF});
+		}
+
+		// Spalva turi būti laisva.
+		constexpr void claim(const uint32_t color) & {
+			const uint32_t r = red(color), g = green(color), b = blue(color);
+			cells[node(depth, r >> 1, g >> 1, b >> 1)] &= aa::cast<uint8_t>(~(1u << (((r & 1) << 2) | ((g & 1) << 1) | (b & 1))));
+			for (uint32_t level = 0; level != depth; ++level) {
+				const uint32_t shift = 8 - level;
+				--counts[offset(level) + node(level, r >> shift, g >> shift, b >> shift)];
+			}
+		}
+
+		// Kitoms gijoms skaitant piramidę, jos skaičiai gali trumpam neatitikti vienas kito.
+		// Lygiai virš shared_level (šaknis, 8 ir 64 kubeliai) bendri visoms gijoms, todėl jie nemažinami kiekvienai spalvai:
+		// tik ištuštėjus shared_level kubeliui iš jų atimama visa jo talpa. Taip jie lieka ne 0 tik tada, kai po jais yra
+		// laisva spalva, bet nebėra tikslūs skaičiai, kol reset() jų neatstato.
+		constexpr void claim_atomic(const uint32_t color) & {
+			const uint32_t r = red(color), g = green(color), b = blue(color);
+			std::atomic_ref{cells[node(depth, r >> 1, g >> 1, b >> 1)]}
+				.fetch_and(aa::cast<uint8_t>(~(1u << (((r & 1) << 2) | ((g & 1) << 1) | (b & 1)))), std::memory_order::relaxed);
+			for (uint32_t level = depth - 1; level >= shared_level; --level) {
+				const uint32_t shift = 8 - level;
+				if (std::atomic_ref{counts[offset(level) + node(level, r >> shift, g >> shift, b >> shift)]}.fetch_sub(1, std::memory_order::relaxed) == 1
+					&& level == shared_level)
+				{
+					for (uint32_t upper = 0; upper != shared_level; ++upper) {
+						const uint32_t upper_shift = 8 - upper;
+						std::atomic_ref{counts[offset(upper) + node(upper, r >> upper_shift, g >> upper_shift, b >> upper_shift)]}
+							.fetch_sub(1u << (3 * (8 - shared_level)), std::memory_order::relaxed);
+					}
+				}
+			}
+		}
+
+		// Kai SHARED, tik ar dar liko laisvų spalvų (žr. claim_atomic), o ne jų skaičius.
+		template<bool SHARED = false>
+		constexpr uint32_t free_count() const & {
+			return shared_load<SHARED>(counts.front());
+		}
+
+		// Artimiausia pagal METRIC laisva spalva, lygūs atstumai renkami atsitiktinai. Jei žinoma, kad laisva spalva yra ne
+		// toliau nei limit, toliau esantys kubeliai iškart atmetami.
+		// Kai SHARED, kitos gijos tuo pat metu užiminėja spalvas (claim_atomic), todėl skaitoma atomiškai, o rezultatas gali būti
+		// jau užimta spalva arba nullopt.
+		template<bool SHARED = false, class R>
+		constexpr std::optional<uint32_t> nearest(const uint32_t color, R && rand, const uint32_t limit = aa::numeric_max) const & {
+			if (!free_count<SHARED>()) return std::nullopt;
+
+			query q = {METRIC::coordinates(color), limit, 0, 0};
+			search<SHARED, 0>(q, 0, 0, 0, rand);
+			return (q.ties ? std::optional{q.best_color} : std::nullopt);
+		}
+	};
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "shell_kernel.hpp"
+#include "utils.hpp"
+
+#include <atomic>
+#include <bit>
+#include <limits>
+#include <optional>
+#include <span>
+
+
+
+namespace {
+	// Panaudotų spalvų aibė, po vieną bitą kiekvienai RGB spalvai (2 MB vietoje 16 MB).
+	// Spalvos bitas yra žodyje color >> 5, todėl viena (r, g) eilutė užima 8 iš eilės einančius žodžius.
+	struct color_set {
+		// Member objects
+	private:
+		static constexpr uint32_t word_bits = std::numeric_limits<uint32_t>::digits;
+
+		std::array<uint32_t, aa::representable_values_v<aa::triplet<std::byte>> / word_bits> words;
+
+
+
+		// Member functions
+	public:
+		constexpr void reset() & {
+			std::ranges::fill(words, 0u);
+		}
+
+		// Kai SHARED, kitos gijos tuo pat metu gali užiminėti spalvas (claim_atomic).
+		template<bool SHARED = false>
+		constexpr bool test(const uint32_t color) const & {
+			return (shared_load<SHARED>(words[color / word_bits]) >> (color % word_bits)) & 1u;
+		}
+
+		// Grąžina true, jei spalva buvo laisva.
+		constexpr bool claim(const uint32_t color) & {
+			uint32_t & word = words[color / word_bits];
+			const uint32_t bit = 1u << (color % word_bits);
+			return !(std::exchange(word, word | bit) & bit);
+		}
+
+		// Grąžina true, jei spalva buvo laisva ir ją užėmė būtent šis kvietimas.
+		constexpr bool claim_atomic(const uint32_t color) & {
+			const uint32_t bit = 1u << (color % word_bits);
+			return !(std::atomic_ref{words[color / word_bits]}.fetch_or(bit, std::memory_order::relaxed) & bit);
+		}
+
+		// Laisvų apvalkalo kandidatų kaukė (žr. shell_kernel.hpp).
+		// Kai kitos gijos tuo pat metu užiminėja spalvas, rezultatas tėra užuomina, kurią patvirtina claim_atomic.
+		constexpr void free_in_shell(const uint32_t color, const std::span<const uint32_t> offsets, uint64_t * const free) const & {
+			shell_free(words.data(), color, offsets, free);
+		}
+
+		// Pirma laisva spalva einant nuo color didėjančia kanalo kryptimi (channel: 0 – raudona, 1 – žalia, 2 – mėlyna).
+		// Kai SHARED, rastoji spalva tėra užuomina, kaip ir free_in_shell.
+		template<size_t channel, bool SHARED = false>
+		constexpr std::optional<uint32_t> find_free(const uint32_t color) const & {
+			if constexpr (channel == 2) {
+				// Mėlynos kanalo kryptimi bitai eina iš eilės, todėl tikriname po visą žodį.
+				const uint32_t row = color & ~0xFFu;
+				for (uint32_t c = color; c <= (row | 0xFFu); c = (c | (word_bits - 1)) + 1) {
+					const uint32_t free = ~shared_load<SHARED>(words[c / word_bits]) >> (c % word_bits);
+					if (free) return c + aa::cast<uint32_t>(std::countr_zero(free));
+				}
+			} else {
+				static constexpr uint32_t shift = (channel ? 8 : 16);
+				for (uint32_t c = color; ; c += (1u << shift)) {
+					if (!test<SHARED>(c)) return c;
+					if (((c >> shift) & 0xFFu) == 0xFFu) break;
+				}
+			}
+			return std::nullopt;
+		}
+	};
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../common/color_metric.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <span>
+
+
+
+namespace {
+	// Spalvų poslinkių apvalkalai iki kvadratinio atstumo MAX_DISTANCE, sugeneruoti kompiliuojant.
+	// Apvalkale atstumu n yra visi (dr, dg, db), kuriems METRIC::offset_distance(dr, dg, db) = n (sRGB – dr² + dg² + db²);
+	// tušti apvalkalai praleidžiami. Tinka tik is_uniform metrikoms.
+	// Poslinkis supakuotas kaip spalva, kiekvienas kanalas – int8_t baitas (0xFF reiškia -1).
+	template<uint32_t MAX_DISTANCE, class METRIC = metric::srgb>
+	struct color_shells {
+		static_assert(METRIC::is_uniform);
+
+		// Member objects
+	private:
+		static constexpr int32_t radius = [] static {
+			int32_t r = 0;
+			while (std::ranges::min({METRIC::offset_distance(r + 1, 0, 0), METRIC::offset_distance(0, r + 1, 0),
+				METRIC::offset_distance(0, 0, r + 1)}) <= MAX_DISTANCE) ++r;
+			return r;
+		}();
+		static_assert(MAX_DISTANCE && radius < 128);
+
+		template<class F>
+		static constexpr void for_each_offset(F && f) {
+			for (int32_t dr = -radius; dr <= radius; ++dr)
+				for (int32_t dg = -radius; dg <= radius; ++dg)
+					for (int32_t db = -radius; db <= radius; ++db) {
+						const uint32_t distance = METRIC::offset_distance(dr, dg, db);
+						if (distance && distance <= MAX_DISTANCE) f(distance,
+							(aa::cast<uint32_t>(aa::cast<uint8_t>(dr)) << 16) |
+							(aa::cast<uint32_t>(aa::cast<uint8_t>(dg)) << 8) |
+							(aa::cast<uint32_t>(aa::cast<uint8_t>(db)) << 0));
+					}
+		}
+
+	public:
+		// sRGB atveju https://oeis.org/A005875, kai MAX_DISTANCE pakankamai didelis.
+		static constexpr std::array<uint32_t, MAX_DISTANCE + 1> sizes_by_distance = [] static {
+			std::array<uint32_t, MAX_DISTANCE + 1> sizes = {};
+			for_each_offset([&](const uint32_t distance, const uint32_t) -> void { ++sizes[distance]; });
+			return sizes;
+		}();
+
+		static constexpr size_t shell_count = aa::unsign(std::ranges::count_if(sizes_by_distance, std::identity{}));
+		static constexpr size_t offset_count = std::accumulate(sizes_by_distance.begin(), sizes_by_distance.end(), 0uz);
+		static constexpr size_t max_shell_size = std::ranges::max(sizes_by_distance);
+
+	private:
+		struct table {
+			std::array<uint32_t, offset_count> offsets;
+			std::array<uint32_t, shell_count + 1> starts;
+			std::array<uint32_t, shell_count> distances;
+		};
+
+		// Apvalkalai eina didėjančio atstumo tvarka, kiekvieno apvalkalo poslinkiai surikiuoti.
+		static constexpr table data = [] static {
+			table t = {};
+			std::array<uint32_t, MAX_DISTANCE + 1> next = {};
+			for (uint32_t distance = 1, shell = 0, start = 0; distance <= MAX_DISTANCE; ++distance) {
+				if (!sizes_by_distance[distance]) continue;
+				t.distances[shell] = distance;
+				t.starts[shell++] = next[distance] = start;
+				start += sizes_by_distance[distance];
+			}
+			t.starts.back() = offset_count;
+
+			for_each_offset([&](const uint32_t distance, const uint32_t offset) -> void { t.offsets[next[distance]++] = offset; });
+			for (size_t shell = 0; shell != shell_count; ++shell) {
+				std::ranges::sort(t.offsets.begin() + t.starts[shell], t.offsets.begin() + t.starts[shell + 1]);
+			}
+			return t;
+		}();
+
+
+
+		// Member functions
+	public:
+		static constexpr std::span<const uint32_t> shell(const size_t index) {
+			return {data.offsets.data() + data.starts[index], data.offsets.data() + data.starts[index + 1]};
+		}
+
+		static constexpr uint32_t distance(const size_t index) {
+			return data.distances[index];
+		}
+	};
+
+	static_assert(std::ranges::equal(std::span{color_shells<22>::sizes_by_distance}.subspan(1), std::to_array<uint32_t>({
+		6, 12, 8, 6, 24, 24, 0, 12, 30, 24, 24, 8, 24, 48, 0, 6, 48, 36, 24, 24, 48, 24
+	})));
+}
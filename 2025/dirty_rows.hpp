@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+
+
+
+namespace {
+	// Eilučių juostos, kuriose auginimo gija pakeitė pikselius nuo paskutinio consume().
+	// Rašo bet kuri gija, skaito ir valo viena (pagrindinė) gija.
+	struct dirty_rows {
+		// Member objects
+	private:
+		static constexpr uint32_t band_height = 16, word_bits = std::numeric_limits<uint64_t>::digits;
+
+		uint32_t width, height, band_pixels, band_count;
+		std::unique_ptr<std::atomic<uint64_t>[]> bands;
+
+
+
+		// Member functions
+	public:
+		constexpr bool init(const uint32_t w, const uint32_t h) & {
+			width = w;
+			height = h;
+			band_pixels = width * band_height;
+			band_count = (height + band_height - 1) / band_height;
+			bands = std::make_unique<std::atomic<uint64_t>[]>((band_count + word_bits - 1) / word_bits);
+			return bands != nullptr;
+		}
+
+		// Engine stebėtojas. Pirmiau tikriname, kad nereikėtų rašyti į bendrą eilutę, kai juosta jau pažymėta.
+		constexpr void on_pixel(const uint32_t index) const & {
+			const uint32_t band = index / band_pixels;
+			std::atomic<uint64_t> & word = bands[band / word_bits];
+			const uint64_t bit = uint64_t{1} << (band % word_bits);
+			if (!(word.load(std::memory_order::relaxed) & bit)) word.fetch_or(bit, std::memory_order::release);
+		}
+
+		// Kviečia f(first_row, row_count) kiekvienai ištisinei pažymėtų juostų sekai ir jas išvalo.
+		template<class F>
+		constexpr void consume(F && f) & {
+			uint32_t run_start = 0, run_length = 0;
+			for (uint32_t w = 0; w != (band_count + word_bits - 1) / word_bits; ++w) {
+				uint64_t bits = bands[w].exchange(0, std::memory_order::acquire);
+				for (uint32_t band = w * word_bits, end = std::ranges::min(band + word_bits, band_count); band != end; ++band, bits >>= 1) {
+					if (bits & 1) {
+						if (!run_length) run_start = band;
+						++run_length;
+					} else if (run_length) {
+						f(run_start * band_height, std::ranges::min(run_length * band_height, height - run_start * band_height));
+						run_length = 0;
+					}
+				}
+			}
+			if (run_length) f(run_start * band_height, std::ranges::min(run_length * band_height, height - run_start * band_height));
+		}
+	};
+}
@@ -0,0 +1,544 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../AA/include/AA/algorithm/arithmetic.hpp"
+#include "../common/bit_mask.hpp"
+#include "../common/color_metric.hpp"
+#include "../common/random.hpp"
+#include "../common/trace.hpp"
+#include "arena.hpp"
+#include "checkpoint.hpp"
+#include "color_index.hpp"
+#include "color_set.hpp"
+#include "color_shells.hpp"
+#include "frontier.hpp"
+#include "mapped_canvas.hpp"
+#include "tiled_layout.hpp"
+#include "utils.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+
+namespace {
+	// Stebėtojas gauna kiekvieno galutinai nuspalvinto pikselio eilutinį indeksą (y * width + x), lygiagrečiai auginant – iš kelių gijų.
+	// Jei jis turi ir interrupted(), ji kviečiama kas interrupt_period pikselių (kiekvienoje gijoje), ir true nutraukia auginimą.
+	struct no_observer {
+		static constexpr void on_pixel(const uint32_t) {}
+	};
+
+	// Kelių šimtų pikselių trukmė – dešimtosios milisekundės dalys, o tikrinimas tėra vienas atominis nuskaitymas.
+	inline constexpr uint32_t interrupt_period = 1024;
+
+	template<class O>
+	constexpr bool is_interrupted(O & observer) {
+		if constexpr (requires { observer.interrupted(); }) return observer.interrupted();
+		else return false;
+	}
+
+	// Profiliavimo taškai (žr. common/trace.hpp). shell_reached – apvalkalo, kuriame rasta spalva, numeris,
+	// shell_count reiškia piramidę, shell_count + 1 – spalvų nebeliko. candidates_probed – kiek poslinkių patikrinta.
+	namespace probes {
+		inline trace::histogram shell_reached{"color.shell_reached", false}, candidates_probed{"color.candidates_probed", true};
+		inline trace::counter steal_ns{"parallel.steal_ns"};
+	}
+
+	// Spalvų auginimo variklis be lango. Pikseliai, kaukė ir krašto indeksai laikomi plytelėmis (žr. tiled_layout.hpp),
+	// eilutinė tvarka naudojama tik init() kaukei ir copy_rows() rezultatui.
+	// FRONTIER – nuosekliojo auginimo krašto politika (žr. frontier.hpp), SHELL_DISTANCE – iki kokio kvadratinio
+	// atstumo ieškoma apvalkaluose, toliau ieškoma piramidėje. METRIC – spalvų atstumas (žr. common/color_metric.hpp);
+	// kai jis ne is_uniform, sRGB apvalkalai baigia paiešką tik su METRIC::beyond(), kitaip ji tęsiama piramidėje.
+	template<class FRONTIER = classic_frontier, uint32_t SHELL_DISTANCE = 48, class METRIC = metric::srgb>
+	struct basic_engine {
+		// Member objects
+	private:
+		// Ne const, nes potencialiai gali pasikeisti.
+		uint32_t width, height, pixel_count;
+
+		tiled_layout layout;
+
+		// Pikseliai, kaukės bitai, spalvų aibės ir kraštas yra viename bloke, kurį init() rezervuoja iš naujo.
+		// Rėmo pikseliai lygūs border, todėl jie niekada nepatenka į kraštą. Jei canvas atidarytas, pikseliai yra jo faile.
+		// Pikselio alfa baitas – paleidimo numeris: pikselis užimtas, jei jis ne mažesnis už stamp, o ankstesnių paleidimų pikseliai laikomi laisvais.
+		// copy_rows() gali būti kviečiama iš kitos gijos auginimo metu, todėl pikseliai rašomi atomiškai (relaxed), o stamp
+		// paskelbiamas su release tik išvalius pikselius.
+		arena memory;
+		mapped_canvas canvas;
+		uint32_t * pixels;
+		// Abi kaukės tiled_layout tvarka. on_boundary – pikseliai, turintys kaimyną kitoje teksto pusėje: tik jų kaimynai gali būti geri.
+		bit_mask is_text, on_boundary;
+		color_set * color_used;
+		color_index<METRIC> * free_colors;
+		FRONTIER frontier;
+		std::atomic<uint32_t> stamp;
+
+		// Kai METRIC ne is_uniform, apvalkalai sRGB, o atstumai skaičiuojami kiekvienai laisvai spalvai atskirai.
+		using shells = color_shells<SHELL_DISTANCE, std::conditional_t<METRIC::is_uniform, METRIC, metric::srgb>>;
+		static constexpr uint32_t border = 0xFF'FF'FF'FFu;
+
+
+
+		// Member functions
+		// Naujas paleidimas tik padidina stamp, todėl pikselių valyti nereikia. Jie išvalomi kas 255 paleidimus, kai alfa persipildo,
+		// ir visada su canvas, kad jo faile alfa liktų 0xFF. Spalvų aibė ir piramidė (kartu apie 5 MB, nuo paveikslo dydžio
+		// nepriklauso) vis tiek išvalomos kiekvieną kartą: tai apie 0.4 ms, kai 1080p auginimas trunka apie 0.5 s, o žymos joms
+		// pridėtų patikrinimą kiekvienam skaitymui, taip pat SIMD apvalkalų tikrinime.
+		constexpr void reset() & {
+			const uint32_t old_stamp = stamp.load(std::memory_order::relaxed);
+			if (canvas.is_open() || old_stamp == 0xFF'00'00'00u) {
+				layout.fill(pixels, 0u, border, [](uint32_t & pixel, const uint32_t value) static -> void {
+					std::atomic_ref{pixel}.store(value, std::memory_order::relaxed);
+				});
+				stamp.store((canvas.is_open() ? 0xFF'00'00'00u : 0x01'00'00'00u), std::memory_order::release);
+			} else stamp.store(old_stamp + 0x01'00'00'00u, std::memory_order::release);
+			if (canvas.is_open()) canvas.reset();
+			const trace::scope phase = trace::scope{"reset_colors"};
+			color_used->reset();
+			free_colors->reset();
+		}
+
+		// Būsena be pikselių ir kaukės, kurią įrašo ir atkuria kontrolinis taškas.
+		template<class F>
+		constexpr void visit_state(F && f) & {
+			uint32_t s = stamp.load(std::memory_order::relaxed);
+			f(&s, 1);
+			stamp.store(s, std::memory_order::release);
+			f(color_used, 1);
+			f(free_colors, 1);
+			frontier.visit_state(f);
+		}
+
+		constexpr checkpoint_header checkpoint_identity() const & {
+			uint64_t mask_hash = rng::mix(uint64_t{width} << 32 | height);
+			for (size_t i = 0; i != bit_mask::word_count(layout.size()); ++i) mask_hash = rng::mix(mask_hash ^ is_text.words[i]);
+			return {
+				.width = width, .height = height, .mask_hash = mask_hash,
+				.frontier_policy = FRONTIER::policy, .frontier_footprint = FRONTIER::footprint(pixel_count),
+				.state_capacity = sizeof(color_set) + sizeof(color_index<METRIC>) + FRONTIER::footprint(pixel_count) + 4096
+			};
+		}
+
+		constexpr bool save_checkpoint(checkpoint_file & file, const growth_state & state) & {
+			const trace::scope phase = trace::scope{"checkpoint"};
+			return file.save(pixels, [&](auto && f) -> void { visit_state(f); }, state);
+		}
+
+		// Find nearest color. Kai SHARED, spalvos užimamos atomiškai ir patikrinimai tėra užuominos.
+		template<bool SHARED, class R>
+		constexpr std::optional<uint32_t> find_color(const uint32_t color, R && rand) & {
+			const auto claim = [&](const uint32_t new_col) -> bool {
+				if constexpr (SHARED) {
+					if (!color_used->claim_atomic(new_col)) return false;
+					free_colors->claim_atomic(new_col);
+				} else {
+					color_used->claim(new_col);
+					free_colors->claim(new_col);
+				}
+				return true;
+			};
+
+			uint64_t probed = 0;
+			const auto record = [&](const size_t depth) -> void {
+				probes::shell_reached.add(depth);
+				probes::candidates_probed.add(probed);
+			};
+
+			// Didesniuose nei 2^24 pikselių paveiksluose spalvos baigiasi, tada apvalkalų tikrinti nebeverta.
+			if (!free_colors->template free_count<SHARED>()) {
+				record(shells::shell_count + 1);
+				return std::nullopt;
+			}
+
+			// Artimi apvalkalai dažniausiai turi laisvą spalvą, kitu atveju ieškome piramidėje.
+			uint32_t limit = aa::numeric_max, best = 0, ties = 0;
+			const metric::point target = METRIC::coordinates(color);
+			for (size_t shell = 0; shell != shells::shell_count; ++shell) {
+				const std::span<const uint32_t> offsets = shells::shell(shell);
+				std::array<uint64_t, (shells::max_shell_size + 63) / 64> free;
+				color_used->free_in_shell(color, offsets, free.data());
+				probed += offsets.size();
+				uint32_t free_count = 0;
+				for (size_t chunk = 0; chunk * 64 < offsets.size(); ++chunk) free_count += aa::unsign(std::popcount(free[chunk]));
+
+				// Kitoms metrikoms artimiausia sRGB prasme laisva spalva nebūtinai artimiausia. Jei metrika turi beyond(), renkame
+				// geriausią (lygiems – atsitiktinai) tol, kol už peržiūrėtų apvalkalų negali būti artimesnės; kitaip tik ribojame piramidę.
+				if constexpr (!METRIC::is_uniform) {
+					if (!free_count) continue;
+					for (size_t chunk = 0; chunk * 64 < offsets.size(); ++chunk) {
+						for (uint64_t pick = free[chunk]; pick; pick &= pick - 1) {
+							const uint32_t new_col = add_offset(color, offsets[chunk * 64 + aa::unsign(std::countr_zero(pick))]);
+							const uint32_t distance = metric::squared_distance(target, METRIC::coordinates(new_col));
+							/**/ if (distance < limit)					limit = distance, best = new_col, ties = 1;
+							else if (distance == limit && !rand(++ties))	best = new_col;
+						}
+					}
+					if constexpr (requires { METRIC::beyond(color, limit); }) {
+						const uint32_t next = ((shell + 1 != shells::shell_count) ? shells::distance(shell + 1) : SHELL_DISTANCE + 1);
+						// Jei net už visų apvalkalų rėžis per mažas, likusius tikrinti neverta.
+						if (limit >= METRIC::beyond(color, next)) {
+							if (limit >= METRIC::beyond(color, SHELL_DISTANCE + 1)) break;
+							continue;
+						}
+						if (claim(best)) {
+							record(shell);
+							return best;
+						}
+					}
+					break;
+				}
+
+				// Atsitiktinai parinkta laisva spalva pasiskirsčiusi taip pat, kaip pirma laisva sumaišytoje tvarkoje.
+				while (free_count) {
+					uint32_t skip = rand(free_count);
+					size_t chunk = 0;
+					for (; skip >= aa::unsign(std::popcount(free[chunk])); ++chunk) skip -= aa::unsign(std::popcount(free[chunk]));
+					uint64_t pick = free[chunk];
+					for (; skip; --skip) pick &= pick - 1;
+
+					const uint32_t bit = aa::unsign(std::countr_zero(pick));
+					if (const uint32_t new_col = add_offset(color, offsets[chunk * 64 + bit]); claim(new_col)) {
+						record(shell);
+						return new_col;
+					}
+					free[chunk] &= ~(uint64_t{1} << bit);
+					--free_count;
+				}
+			}
+
+			// Laisva spalva toje pačioje (r, g) eilutėje randama peržiūrėjus kelis žodžius, o jos atstumas nukerta toliau esančius
+			// piramidės kubelius. color alfa baite yra paleidimo numeris, todėl jis nuimamas. Jei spalvų nebeliko (daugiau nei
+			// 2^24 pikselių), grąžiname nullopt.
+			if (const std::optional row_col = color_used->template find_free<2, SHARED>(color & 0x00'FF'FF'FFu))
+				limit = std::ranges::min(limit, metric::squared_distance(target, METRIC::coordinates(*row_col)));
+			while (free_colors->template free_count<SHARED>()) {
+				if (const std::optional new_col = free_colors->template nearest<SHARED>(color, rand, limit); new_col && claim(*new_col)) {
+					record(shells::shell_count);
+					return new_col;
+				}
+				limit = aa::numeric_max;
+			}
+			record(shells::shell_count + 1);
+			return std::nullopt;
+		}
+
+		// Pirmas pikselis ir jo spalva.
+		constexpr growth_state start(const uint64_t seed) & {
+			{
+				const trace::scope phase = trace::scope{"reset"};
+				reset();
+			}
+
+			frontier.clear();
+			growth_state state = {rng::stream{seed}, 0, 1};
+			const uint32_t first = state.stream.below(pixel_count), first_index = layout.index(first % width, first / width);
+			frontier.push(first_index, false);
+			std::atomic_ref{pixels[first_index]}.store(stamp.load(std::memory_order::relaxed) | state.stream.below(0x01'00'00'00u),
+				std::memory_order::relaxed);
+			return state;
+		}
+
+		// Nuoseklus auginimas iki galo arba kol observer.interrupted(). Su CHECKPOINT kas interval (tikrinama kas 4096 pikselių),
+		// pabaigoje ir nutraukus įrašomas kontrolinis taškas. false – nutraukta arba nepavyko įrašyti.
+		template<bool CHECKPOINT, class O>
+		constexpr bool grow_from(growth_state & state, O & observer, checkpoint_file * const file, const std::chrono::milliseconds interval) & {
+			const auto rand = [&](const uint32_t n) -> uint32_t { return state.stream.below(n); };
+			std::chrono::steady_clock::time_point last_save = std::chrono::steady_clock::now();
+
+			// Profiliuojant kas 65536 pikselius užbaigiamas intervalas ir įrašomas krašto dydis.
+			trace::laps chunk = trace::laps{"pixels_64k"};
+			const uint32_t run_stamp = stamp.load(std::memory_order::relaxed);
+			while (!frontier.empty()) {
+				const uint32_t curr_index = frontier.pop(rand);
+				// Rašo tik ši gija, todėl skaityti galima paprastai.
+				uint32_t curr_color = pixels[curr_index];
+				--state.frontier_size;
+
+				// Jei spalvų nebeliko, pikselis pasilieka kaimyno spalvą.
+				if (const std::optional new_col = find_color<false>(curr_color, rand))
+					std::atomic_ref{pixels[curr_index]}.store(curr_color = run_stamp | *new_col, std::memory_order::relaxed);
+				observer.on_pixel(layout.linear(curr_index));
+				if (canvas.is_open()) canvas.claim(curr_index);
+				if constexpr (CHECKPOINT) file->touch(curr_index);
+
+				// Find neighbors
+				const bool is_boundary = on_boundary.test(curr_index);
+				layout.for_each_neighbor(curr_index, [&](const uint32_t new_index) -> void {
+					if (pixels[new_index] >= run_stamp) return;
+					frontier.push(new_index, is_boundary && is_text.test(curr_index) != is_text.test(new_index));
+					std::atomic_ref{pixels[new_index]}.store(curr_color, std::memory_order::relaxed);
+					++state.frontier_size;
+					if constexpr (CHECKPOINT) file->touch(new_index);
+				});
+
+				++state.done;
+				if (!(state.done % interrupt_period) && is_interrupted(observer)) {
+					if constexpr (CHECKPOINT) save_checkpoint(*file, state);
+					return false;
+				}
+				if constexpr (trace::enabled) if (!(state.done & 0xFF'FFu)) {
+					chunk.lap();
+					trace::sample("frontier", state.frontier_size);
+				}
+				if constexpr (CHECKPOINT) if (!(state.done & 0xF'FFu) && std::chrono::steady_clock::now() - last_save >= interval) {
+					if (!save_checkpoint(*file, state)) return false;
+					last_save = std::chrono::steady_clock::now();
+				}
+			}
+			if constexpr (CHECKPOINT) return save_checkpoint(*file, state);
+			return true;
+		}
+
+	public:
+		// Ar grow_parallel() auga su FRONTIER. Lygiagretus auginimas moka tik klasikinę politiką, kitos auginamos grow() viena gija.
+		static constexpr bool is_parallel = std::is_same_v<FRONTIER, classic_frontier>;
+
+		// mask – vienas baitas vienam pikseliui (ne 0 – tekstas), tarp eilučių mask_pitch baitų (pvz., SDL paviršiaus pitch).
+		// Paverčiama bitais, todėl po init() nebereikalinga.
+		// canvas_path – paveikslams, netelpantiems į RAM: pikseliai laikomi šiame faile (žr. mapped_canvas), kuris po grow() ir flush()
+		// yra plytelėmis išdėstytas rezultatas. Kitaip viskas laikoma atmintyje.
+		constexpr bool init(const uint32_t w, const uint32_t h, const uint8_t * const mask, const size_t mask_pitch,
+			const char * const canvas_path = nullptr) &
+		{
+			width = w;
+			height = h;
+			pixel_count = width * height;
+			layout.init(width, height);
+			if (!canvas_path) canvas.close();
+			else if (!canvas.open(canvas_path, layout)) return false;
+
+			const size_t mask_words = bit_mask::word_count(layout.size());
+			if (!memory.reserve((canvas_path ? 0 : arena::footprint<uint32_t>(layout.size())) + 2 * arena::footprint<uint64_t>(mask_words)
+				+ arena::footprint<color_set>(1) + arena::footprint<color_index<METRIC>>(1) + FRONTIER::footprint(pixel_count))) return false;
+			pixels = (canvas_path ? canvas.get_pixels() : memory.allocate<uint32_t>(layout.size()));
+			is_text = {memory.allocate<uint64_t>(mask_words)};
+			on_boundary = {memory.allocate<uint64_t>(mask_words)};
+			color_set * const set = memory.allocate<color_set>(1);
+			color_index<METRIC> * const index = memory.allocate<color_index<METRIC>>(1);
+			if (!pixels || !is_text.words || !on_boundary.words || !set || !index) return false;
+			is_text.clear(layout.size());
+			on_boundary.clear(layout.size());
+			for (uint32_t y = 0; y != height; ++y) {
+				for (uint32_t x = 0; x != width; ++x) {
+					if (mask[y * mask_pitch + x]) is_text.set(layout.index(x, y));
+				}
+			}
+			mark_boundary(is_text, on_boundary, width, height, [&](const uint32_t x, const uint32_t y) -> uint32_t { return layout.index(x, y); });
+			color_used = std::ranges::construct_at(set);
+			free_colors = std::ranges::construct_at(index);
+			// Kad pirmas reset() išvalytų pikselius.
+			stamp.store(0xFF'00'00'00u, std::memory_order::relaxed);
+			return frontier.init(pixel_count, memory);
+		}
+
+		constexpr uint32_t get_width() const & { return width; }
+		constexpr uint32_t get_height() const & { return height; }
+		constexpr uint32_t get_pixel_count() const & { return pixel_count; }
+
+		// ARGB eilutės [first_row, first_row + row_count) į out, tarp eilučių pitch pikselių. Dar nenuspalvinti pikseliai juodi.
+		// Galima kviesti ir auginimo metu iš kitos gijos: tada matoma kuri nors tarpinė būsena.
+		constexpr void copy_rows(const uint32_t first_row, const uint32_t row_count, uint32_t * const out, const size_t pitch) const & {
+			layout.copy_to_linear(pixels, first_row, row_count, out, pitch,
+				[s = stamp.load(std::memory_order::acquire)](const uint32_t & pixel) -> uint32_t {
+					const uint32_t p = shared_load<true>(pixel);
+					return ((p >= s) ? (p | 0xFF'00'00'00u) : 0u);
+				});
+		}
+
+		// Įrašo canvas failą į diską. Be canvas nieko nedaro.
+		constexpr bool flush() const & {
+			return !canvas.is_open() || canvas.flush();
+		}
+
+		// Tas pats seed duoda tą patį paveikslą. false – nutraukė stebėtojas, tada paveikslas nebaigtas.
+		template<class O = no_observer>
+		constexpr bool grow(const uint64_t seed, O && observer = {}) & {
+			const trace::scope whole = trace::scope{"grow"};
+			growth_state state = start(seed);
+			return grow_from<false>(state, observer, nullptr, {});
+		}
+
+		// Kaip grow(), bet kas interval būsena įrašoma į kontrolinio taško failą path (žr. checkpoint.hpp), kad nutrauktą
+		// auginimą būtų galima pratęsti su resume(). Paveikslas toks pat kaip grow() su tuo pačiu seed, kad ir kiek kartų pratęstas.
+		// Su canvas neveikia. false – nepavyko įrašyti arba nutraukė stebėtojas (tada kontrolinis taškas įrašytas).
+		template<class O = no_observer>
+		constexpr bool grow_checkpointed(const uint64_t seed, const char * const path, const std::chrono::milliseconds interval,
+			O && observer = {}) &
+		{
+			const trace::scope whole = trace::scope{"grow"};
+			checkpoint_file file;
+			if (canvas.is_open() || !file.create(path, layout, checkpoint_identity())) return false;
+			growth_state state = start(seed);
+			return grow_from<true>(state, observer, &file, interval);
+		}
+
+		// Ar path yra šiam varikliui (matmenys, kaukė, krašto politika) tinkamas kontrolinis taškas su bent vienu įrašytu lizdu.
+		// Failas, sukurtas grow_checkpointed(), netinka, kol neįrašytas pirmas taškas.
+		constexpr bool can_resume(const char * const path) const & {
+			checkpoint_file file;
+			return !canvas.is_open() && file.open(path, layout, checkpoint_identity()) && file.has_slot();
+		}
+
+		// Tęsia nuo paskutinio path kontrolinio taško ir toliau juos rašo. init() turi būti iškviestas su tais pačiais matmenimis
+		// ir kauke, o variklis – tos pačios krašto politikos. false – failas netinka, nepavyko įrašyti arba nutraukta.
+		template<class O = no_observer>
+		constexpr bool resume(const char * const path, const std::chrono::milliseconds interval, O && observer = {}) & {
+			const trace::scope whole = trace::scope{"grow"};
+			checkpoint_file file;
+			if (canvas.is_open() || !file.open(path, layout, checkpoint_identity())) return false;
+			std::optional state = file.load(pixels, [&](auto && f) -> void { visit_state(f); });
+			return state && grow_from<true>(*state, observer, &file, interval);
+		}
+
+		// Tas pats auginimas thread_count gijose su klasikine politika, todėl kviečiamas tik kai is_parallel. Kiekviena gija turi savo kraštą
+		// ir, jam ištuštėjus, pasiima pusę kitos gijos krašto. Pikseliai ir spalvos užimami atomiškai, todėl kiekviena spalva panaudojama
+		// tik kartą. Kiekviena gija turi savo seed srautą, bet rezultatas priklauso ir nuo gijų tvarkaraščio. false – nutraukė stebėtojas.
+		template<class O = no_observer>
+		constexpr bool grow_parallel(const uint32_t thread_count, const uint64_t seed, O && observer = {}) & {
+			static_assert(is_parallel);
+			const trace::scope whole = trace::scope{"grow_parallel"};
+			{
+				const trace::scope phase = trace::scope{"reset"};
+				reset();
+			}
+
+			struct worker {
+				std::mutex lock;
+				std::vector<uint32_t> neighbors, good_neighbors;
+				rng::stream stream = rng::stream{0};
+			};
+			const std::unique_ptr workers = std::make_unique<worker[]>(thread_count);
+
+			// pending – kiek pikselių yra kraštuose, bet dar neapdorota. Gija savo pokytį kaupia ir prideda kas batch pikselių arba
+			// ištuštėjus jos kraštui, todėl bendras skaičius tikslus tik tada, kai visos gijos be darbo, o kitu metu gali būti ir per mažas.
+			// work didėja su kiekvienu pending pakeitimu: gija be darbo laukia, kol jis pasikeis (std::atomic::wait), todėl
+			// neužima branduolio ir per pauzę. idle – kiek gijų laukia. stopped – kuri nors gija gavo interrupted(), tada likusios irgi grįžta.
+			static constexpr int64_t batch = 256;
+			std::atomic<int64_t> pending = 1;
+			std::atomic<uint32_t> work = 0, idle = 0;
+			std::atomic<bool> stopped = false;
+			const uint32_t run_stamp = stamp.load(std::memory_order::relaxed);
+
+			{
+				rng::stream stream = rng::stream{seed};
+				const uint32_t first = stream.below(pixel_count), first_index = layout.index(first % width, first / width);
+				workers[0].neighbors.emplace_back(first_index);
+				std::atomic_ref{pixels[first_index]}.store(run_stamp | stream.below(0x01'00'00'00u), std::memory_order::relaxed);
+				for (uint32_t id = 0; id != thread_count; ++id) workers[id].stream = stream.split(id);
+			}
+
+			std::vector<std::jthread> threads;
+			threads.reserve(thread_count);
+			for (uint32_t id = 0; id != thread_count; ++id) threads.emplace_back([&, id] -> void {
+				worker & self = workers[id];
+				const auto rand = [&](const uint32_t n) -> uint32_t { return self.stream.below(n); };
+
+				const auto pop = [&] -> std::optional<uint32_t> {
+					const std::scoped_lock guard = std::scoped_lock{self.lock};
+					std::vector<uint32_t> & curr_neighbors =
+						(self.neighbors.empty() || (!self.good_neighbors.empty() && !rand(10'000u)))
+						? self.good_neighbors : self.neighbors;
+					if (curr_neighbors.empty()) return std::nullopt;
+					((&curr_neighbors == &self.good_neighbors) ? probes::good_picks : probes::normal_picks).add();
+
+					std::ranges::swap(curr_neighbors[rand(aa::cast<uint32_t>(curr_neighbors.size()))], curr_neighbors.back());
+					const uint32_t index = curr_neighbors.back();
+					curr_neighbors.pop_back();
+					return index;
+				};
+
+				const auto steal = [&] -> bool {
+					for (uint32_t i = 1; i != thread_count; ++i) {
+						worker & victim = workers[(id + i) % thread_count];
+						const std::scoped_lock guard = std::scoped_lock{self.lock, victim.lock};
+
+						bool stolen = false;
+						for (const auto member : {&worker::neighbors, &worker::good_neighbors}) {
+							std::vector<uint32_t> & from = victim.*member, & to = self.*member;
+							const auto half = from.end() - aa::sign((from.size() + 1) / 2);
+							to.insert(to.end(), half, from.end());
+							from.erase(half, from.end());
+							stolen |= !to.empty();
+						}
+						if (stolen) return true;
+					}
+					return false;
+				};
+
+				int64_t delta = 0;
+				const auto publish = [&] -> void {
+					if (!delta) return;
+					const bool done = pending.fetch_add(delta) + delta <= 0;
+					delta = 0;
+					work.fetch_add(1);
+					if (done || idle.load()) work.notify_all();
+				};
+
+				// Profiliuojant: visas gijos darbas ir kas 16384 pikselių intervalai, vagystėms ir laukimui – tik bendra trukmė.
+				const trace::scope whole_worker = trace::scope{"worker"};
+				trace::laps chunk = trace::laps{"pixels_16k"};
+				uint32_t claimed = 0;
+
+				while (!stopped.load(std::memory_order::relaxed)) {
+					const std::optional curr_index = pop();
+					if (!curr_index) {
+						const trace::timed phase = trace::timed{probes::steal_ns};
+						publish();
+						// idle padidinamas prieš nuskaitant work, o pakeitusi pending gija jį tikrina po to, todėl pažadinimas nepraleidžiamas.
+						idle.fetch_add(1);
+						const uint32_t seen = work.load();
+						const bool stolen = steal(), done = !stolen && pending.load() <= 0;
+						if (!stolen && !done && !stopped.load(std::memory_order::relaxed)) work.wait(seen);
+						idle.fetch_sub(1, std::memory_order::relaxed);
+						if (done) break;
+						continue;
+					}
+
+					const std::atomic_ref curr_pixel = std::atomic_ref{pixels[*curr_index]};
+					uint32_t curr_color = curr_pixel.load(std::memory_order::relaxed);
+					if (const std::optional new_col = find_color<true>(curr_color, rand))
+						curr_pixel.store(curr_color = run_stamp | *new_col, std::memory_order::relaxed);
+					observer.on_pixel(layout.linear(*curr_index));
+					if (canvas.is_open()) canvas.claim_atomic(*curr_index);
+
+					// Find neighbors
+					std::array<uint32_t, 4> found;
+					size_t size = 0;
+					layout.for_each_neighbor(*curr_index, [&](const uint32_t new_index) -> void {
+						const std::atomic_ref pixel = std::atomic_ref{pixels[new_index]};
+						uint32_t expected = pixel.load(std::memory_order::relaxed);
+						if (expected < run_stamp && pixel.compare_exchange_strong(expected, curr_color, std::memory_order::relaxed))
+							found[size++] = new_index;
+					});
+					if (size) {
+						const bool is_boundary = on_boundary.test(*curr_index);
+						const std::scoped_lock guard = std::scoped_lock{self.lock};
+						for (const uint32_t new_index : std::span{found.data(), size}) {
+							((is_boundary && is_text.test(*curr_index) != is_text.test(new_index)) ? self.good_neighbors : self.neighbors).emplace_back(new_index);
+						}
+					}
+					if (delta += aa::sign(size) - 1; delta >= batch || delta <= -batch) publish();
+
+					if (!(++claimed % interrupt_period) && is_interrupted(observer)) {
+						stopped.store(true, std::memory_order::relaxed);
+						work.fetch_add(1);
+						work.notify_all();
+					}
+					if constexpr (trace::enabled) if (!(claimed & 0x3F'FFu)) {
+						chunk.lap();
+						trace::sample("frontier", aa::cast<double>(pending.load(std::memory_order::relaxed)));
+					}
+				}
+			});
+			threads.clear();
+			return !stopped.load(std::memory_order::relaxed);
+		}
+	};
+
+	using engine = basic_engine<>;
+}
@@ -0,0 +1,132 @@
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../AA/include/AA/container/managed.hpp"
+#include "engine.hpp"
+#include "mask_source.hpp"
+#include "utils.hpp"
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <SDL3_image/SDL_image.h>
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+
+// Usage: farm <count> <width> <height> <first_seed> <output_dir> [threads] [--font=<ttf> | --mask=<image>]. Paveikslai su seed
+// first_seed .. first_seed + count - 1 auginami po vieną kiekvienoje gijoje (numatytai – tiek, kiek branduolių), todėl kiekvienas
+// toks pat kaip headless su viena gija. Kaukė kaip headless (žr. mask_source.hpp): numatytas šriftas yra tik Windows'e.
+// Kaukė paruošiama vieną kartą ir tik skaitoma, spalvų lentelės statinės, o kiekviena gija turi savo variklį su savo arena,
+// kurį init() kartą ir toliau tik perkrauna. Jau esantys <output_dir>/img_<seed>.png praleidžiami, todėl nutrauktą partiją
+// pratęsia ta pati komanda. Pabaigoje į stdout išvedama, kiek paveikslų per valandą.
+int main(const int argc, char ** const argv) {
+	static constexpr std::string_view display_text = "Ačiū"sv;
+
+	mask_source source;
+	const std::vector<std::string_view> args = source.parse(argc, argv);
+	if (E<error_kind::bad_argv>(args.size() == 6 || args.size() == 7)) return EXIT_FAILURE;
+
+	const auto parse = [](const std::string_view arg) static -> uint64_t {
+		uint64_t value = 0;
+		const auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+		return ((ec == std::errc{} && ptr == arg.data() + arg.size()) ? value : 0);
+	};
+	const uint64_t count = parse(args[1]), first_seed = parse(args[4]);
+	const uint32_t width = aa::cast<uint32_t>(std::ranges::min(parse(args[2]), uint64_t{UINT32_MAX})),
+		height = aa::cast<uint32_t>(std::ranges::min(parse(args[3]), uint64_t{UINT32_MAX})),
+		thread_count = ((args.size() == 7) ? aa::cast<uint32_t>(std::ranges::min(parse(args[6]), uint64_t{UINT32_MAX}))
+			: aa::unsign(SDL_GetNumLogicalCPUCores()));
+	const std::filesystem::path output_dir = args[5];
+	if (E<error_kind::bad_argv>(count && width && height && thread_count && (args[4] == "0"sv || first_seed))) return EXIT_FAILURE;
+
+	// Bendra visoms gijoms kaukė, po baitą pikseliui kaip engine::init().
+	const std::unique_ptr mask = std::make_unique_for_overwrite<uint8_t[]>(size_t{width} * height);
+	{
+		// SDL_CreateSurface užpildo pikselius nuliais, todėl fonas juodas.
+		const aa::managed<SDL_Surface *, SDL_DestroySurface> canvas =
+			SDL_CreateSurface(aa::sign(width), aa::sign(height), SDL_PixelFormat::SDL_PIXELFORMAT_XRGB8888);
+		if (E(canvas.has_ownership())) return EXIT_FAILURE;
+
+		if (!source.draw(canvas, display_text)) return EXIT_FAILURE;
+
+		const aa::managed<SDL_Surface *, SDL_DestroySurface> is_text_srf =
+			SDL_ConvertSurface(canvas, SDL_PixelFormat::SDL_PIXELFORMAT_RGB332);
+		if (E(is_text_srf.has_ownership())) return EXIT_FAILURE;
+		for (uint32_t y = 0; y != height; ++y) {
+			std::ranges::copy_n(static_cast<const uint8_t *>(is_text_srf->pixels) + size_t{y} * aa::unsign(is_text_srf->pitch), width,
+				mask.get() + size_t{y} * width);
+		}
+	}
+	while (TTF_WasInit()) {
+		TTF_Quit();
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(output_dir, error);
+	if (E<error_kind::bad_file>(!error)) return EXIT_FAILURE;
+
+	// Darbai dalinami po vieną iš bendro skaitiklio, todėl greitesnės gijos tiesiog paima daugiau.
+	std::atomic<uint64_t> next_job = 0;
+	std::atomic<uint64_t> made = 0;
+	std::atomic<bool> failed = false;
+	std::mutex print_lock;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	{
+		std::vector<std::jthread> workers;
+		workers.reserve(thread_count);
+		for (uint32_t id = 0; id != thread_count; ++id) workers.emplace_back([&] -> void {
+			std::unique_ptr<engine> generator;
+			aa::managed<SDL_Surface *, SDL_DestroySurface> image;
+
+			for (uint64_t job; !failed.load(std::memory_order::relaxed) && (job = next_job.fetch_add(1, std::memory_order::relaxed)) < count;) {
+				const uint64_t seed = first_seed + job;
+				const std::filesystem::path path = output_dir / std::format("img_{}.png", seed);
+				if (std::filesystem::exists(path)) continue;
+
+				// Variklis ir paviršius kuriami tik prireikus, kad pratęsiant beveik baigtą partiją nereikėtų atminties.
+				if (!generator) {
+					generator = std::make_unique<engine>();
+					image = SDL_CreateSurface(aa::sign(width), aa::sign(height), SDL_PixelFormat::SDL_PIXELFORMAT_ARGB8888);
+					if (E(image.has_ownership()) || E<error_kind::bad_data>(generator->init(width, height, mask.get(), width))) {
+						failed.store(true, std::memory_order::relaxed);
+						return;
+					}
+				}
+
+				generator->grow(seed);
+				generator->copy_rows(0, height, static_cast<uint32_t *>(image->pixels), aa::unsign(image->pitch / 4));
+
+				// Įrašoma į laikiną failą ir pervadinama, kad nutraukus neliktų pusiau įrašyto paveikslo, kuris būtų praleistas.
+				std::filesystem::path partial = path;
+				partial += ".part";
+				std::error_code rename_error;
+				if (E(IMG_SavePNG(image, partial.string().data()))
+					|| (std::filesystem::rename(partial, path, rename_error), E<error_kind::bad_file>(!rename_error))) {
+					failed.store(true, std::memory_order::relaxed);
+					return;
+				}
+
+				made.fetch_add(1, std::memory_order::relaxed);
+				const std::scoped_lock guard = std::scoped_lock{print_lock};
+				std::println("{}", path.string());
+			}
+		});
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::println("{} paveikslų {}x{} per {:.1f} s {} gijose: {:.0f} per valandą", made.load(), width, height, seconds, thread_count,
+		aa::cast<double>(made.load()) / seconds * 3600);
+	return (failed.load() ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,366 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../common/trace.hpp"
+#include "arena.hpp"
+
+#include <bit>
+
+
+
+// Krašto (dar nenuspalvintų kaimynų) pasirinkimo politikos. Kiekviena turi footprint(capacity), init(capacity, memory),
+// empty(), clear(), push(index, good), pop(rand) ir visit_state(f). Buferiai imami iš variklio arenos. good reiškia, kad pikselis yra kitoje teksto ribos pusėje nei jo tėvas.
+// policy – kiekvienai politikai ir jos parametrams skirtingas skaičius, kad kontrolinis taškas neatkurtų kitos politikos būsenos.
+// rand(n) grąžina tolygų skaičių iš [0, n). visit_state kviečia f(data, count) kiekvienai būsenos sričiai (kontroliniams taškams).
+// Kiekiai eina prieš buferius, kurių ilgį jie nusako, todėl tas pats kvietimas tinka ir įrašyti, ir atkurti.
+namespace {
+	// Profiliavimo taškai (žr. common/trace.hpp): kiek kartų išimtas ribos ir kiek paprastas kaimynas.
+	namespace probes {
+		inline trace::counter good_picks{"frontier.good_picks"}, normal_picks{"frontier.normal_picks"};
+	}
+
+	// Pradinė elgsena: tolygiai iš paprastų kaimynų, retkarčiais iš ribos kaimynų.
+	struct classic_frontier {
+		// Member objects
+	private:
+		uint32_t * neighbors, * good_neighbors;
+		uint32_t neighbor_count = 0, good_count = 0;
+
+
+
+		// Member functions
+	public:
+		static constexpr uint64_t policy = 1;
+
+		static constexpr size_t footprint(const uint32_t capacity) {
+			return 2 * arena::footprint<uint32_t>(capacity);
+		}
+
+		constexpr bool init(const uint32_t capacity, arena & memory) & {
+			neighbors = memory.allocate<uint32_t>(capacity);
+			good_neighbors = memory.allocate<uint32_t>(capacity);
+			neighbor_count = good_count = 0;
+			return neighbors && good_neighbors;
+		}
+
+		constexpr bool empty() const & {
+			return !neighbor_count && !good_count;
+		}
+
+		constexpr void clear() & {
+			neighbor_count = good_count = 0;
+		}
+
+		constexpr void push(const uint32_t index, const bool good) & {
+			if (good)	good_neighbors[good_count++] = index;
+			else		neighbors[neighbor_count++] = index;
+		}
+
+		template<class R>
+		constexpr uint32_t pop(R && rand) & {
+			const bool good = !neighbor_count || (good_count && !rand(10'000u));
+			(good ? probes::good_picks : probes::normal_picks).add();
+			uint32_t * const items = (good ? good_neighbors : neighbors);
+			uint32_t & size = (good ? good_count : neighbor_count);
+
+			uint32_t & slot = items[rand(size)];
+			const uint32_t index = slot;
+			slot = items[--size];
+			return index;
+		}
+
+		template<class F>
+		constexpr void visit_state(F && f) & {
+			f(&neighbor_count, 1);
+			f(&good_count, 1);
+			f(neighbors, neighbor_count);
+			f(good_neighbors, good_count);
+		}
+	};
+
+	// BFS: pirmas įdėtas, pirmas išimtas. Kiekvienas pikselis įdedamas ne daugiau kartų nei vieną, todėl žiedo nereikia.
+	struct fifo_frontier {
+		// Member objects
+	private:
+		uint32_t * queue;
+		uint32_t head = 0, tail = 0;
+
+
+
+		// Member functions
+	public:
+		static constexpr uint64_t policy = 2;
+
+		static constexpr size_t footprint(const uint32_t capacity) {
+			return arena::footprint<uint32_t>(capacity);
+		}
+
+		constexpr bool init(const uint32_t capacity, arena & memory) & {
+			queue = memory.allocate<uint32_t>(capacity);
+			head = tail = 0;
+			return queue != nullptr;
+		}
+
+		constexpr bool empty() const & {
+			return head == tail;
+		}
+
+		constexpr void clear() & {
+			head = tail = 0;
+		}
+
+		constexpr void push(const uint32_t index, const bool) & {
+			queue[tail++] = index;
+		}
+
+		template<class R>
+		constexpr uint32_t pop(R &&) & {
+			const uint32_t index = queue[head++];
+			if (head == tail) head = tail = 0;
+			return index;
+		}
+
+		template<class F>
+		constexpr void visit_state(F && f) & {
+			f(&head, 1);
+			f(&tail, 1);
+			f(queue + head, tail - head);
+		}
+	};
+
+	// DFS: paskutinis įdėtas, pirmas išimtas.
+	struct lifo_frontier {
+		// Member objects
+	private:
+		uint32_t * stack;
+		uint32_t size = 0;
+
+
+
+		// Member functions
+	public:
+		static constexpr uint64_t policy = 3;
+
+		static constexpr size_t footprint(const uint32_t capacity) {
+			return arena::footprint<uint32_t>(capacity);
+		}
+
+		constexpr bool init(const uint32_t capacity, arena & memory) & {
+			stack = memory.allocate<uint32_t>(capacity);
+			size = 0;
+			return stack != nullptr;
+		}
+
+		constexpr bool empty() const & {
+			return !size;
+		}
+
+		constexpr void clear() & {
+			size = 0;
+		}
+
+		constexpr void push(const uint32_t index, const bool) & {
+			stack[size++] = index;
+		}
+
+		template<class R>
+		constexpr uint32_t pop(R &&) & {
+			return stack[--size];
+		}
+
+		template<class F>
+		constexpr void visit_state(F && f) & {
+			f(&size, 1);
+			f(stack, size);
+		}
+	};
+
+	// Elementai suskirstyti į krepšius su pastoviais svoriais. Krepšys renkamas proporcingai svoris * dydis
+	// Fenwick medžiu per O(log krepšių), o krepšio viduje – tolygiai, išimant sukeitimu su paskutiniu.
+	struct bucket_sampler {
+		// Member objects
+	private:
+		uint32_t bucket_count, bucket_capacity;
+		uint32_t * items, * sizes, * weights;
+		uint64_t * tree;
+		uint64_t total;
+
+
+
+		// Member functions
+		constexpr void add(const uint32_t bucket, const uint64_t delta) & {
+			for (uint32_t i = bucket + 1; i <= bucket_count; i += i & -i) tree[i] += delta;
+			total += delta;
+		}
+
+		// Mažiausias krepšys, kurio prefikso suma didesnė už target.
+		constexpr uint32_t find(uint64_t target) const & {
+			uint32_t pos = 0;
+			for (uint32_t step = std::bit_floor(bucket_count); step; step >>= 1) {
+				if (pos + step <= bucket_count && tree[pos + step] <= target) {
+					pos += step;
+					target -= tree[pos];
+				}
+			}
+			return pos;
+		}
+
+	public:
+		static constexpr size_t footprint(const uint32_t count, const uint32_t capacity) {
+			return arena::footprint<uint32_t>(size_t{count} * capacity) + 2 * arena::footprint<uint32_t>(count)
+				+ arena::footprint<uint64_t>(count + 1);
+		}
+
+		template<class W>
+		constexpr bool init(const uint32_t count, const uint32_t capacity, arena & memory, W && weight) & {
+			bucket_count = count;
+			bucket_capacity = capacity;
+			items = memory.allocate<uint32_t>(size_t{bucket_count} * bucket_capacity);
+			sizes = memory.allocate<uint32_t>(bucket_count);
+			weights = memory.allocate<uint32_t>(bucket_count);
+			tree = memory.allocate<uint64_t>(bucket_count + 1);
+			if (!items || !sizes || !weights || !tree) return false;
+
+			clear();
+			for (uint32_t bucket = 0; bucket != bucket_count; ++bucket) weights[bucket] = weight(bucket);
+			return true;
+		}
+
+		constexpr bool empty() const & {
+			return !total;
+		}
+
+		constexpr void clear() & {
+			total = 0;
+			std::ranges::fill_n(sizes, bucket_count, 0u);
+			std::ranges::fill_n(tree, bucket_count + 1, uint64_t{0});
+		}
+
+		constexpr void push(const uint32_t bucket, const uint32_t index) & {
+			items[size_t{bucket} * bucket_capacity + sizes[bucket]++] = index;
+			add(bucket, weights[bucket]);
+		}
+
+		template<class R>
+		constexpr uint32_t pop(R && rand) & {
+			const uint64_t target = ((aa::cast<uint64_t>(rand(1u << 30)) << 30) | rand(1u << 30)) % total;
+			const uint32_t bucket = find(target);
+
+			uint32_t * const first = items + size_t{bucket} * bucket_capacity;
+			uint32_t & slot = first[rand(sizes[bucket])];
+			const uint32_t index = slot;
+			slot = first[--sizes[bucket]];
+			add(bucket, -aa::cast<uint64_t>(weights[bucket]));
+			return index;
+		}
+
+		// Svoriai nekinta nuo init(), todėl neįeina.
+		template<class F>
+		constexpr void visit_state(F && f) & {
+			f(&total, 1);
+			f(sizes, bucket_count);
+			f(tree, bucket_count + 1);
+			for (uint32_t bucket = 0; bucket != bucket_count; ++bucket) f(items + size_t{bucket} * bucket_capacity, sizes[bucket]);
+		}
+	};
+
+	// Ribos kaimynai renkami GOOD_WEIGHT kartų dažniau nei paprasti.
+	template<uint32_t GOOD_WEIGHT = 64>
+	struct boundary_frontier {
+		// Member objects
+	private:
+		bucket_sampler sampler;
+
+
+
+		// Member functions
+	public:
+		static constexpr uint64_t policy = uint64_t{4} << 32 | GOOD_WEIGHT;
+
+		static constexpr size_t footprint(const uint32_t capacity) {
+			return bucket_sampler::footprint(2, capacity);
+		}
+
+		constexpr bool init(const uint32_t capacity, arena & memory) & {
+			return sampler.init(2, capacity, memory, [](const uint32_t bucket) static { return (bucket ? GOOD_WEIGHT : 1u); });
+		}
+
+		constexpr bool empty() const & {
+			return sampler.empty();
+		}
+
+		constexpr void clear() & {
+			sampler.clear();
+		}
+
+		constexpr void push(const uint32_t index, const bool good) & {
+			sampler.push(good, index);
+		}
+
+		template<class R>
+		constexpr uint32_t pop(R && rand) & {
+			return sampler.pop(rand);
+		}
+
+		template<class F>
+		constexpr void visit_state(F && f) & {
+			sampler.visit_state(f);
+		}
+	};
+
+	// Svoris priklauso nuo įdėjimo laiko: FAVOR_OLD renkasi senesnius kaimynus (artimiau BFS), kitaip – naujesnius.
+	// Per vieną auginimą įdedama ne daugiau capacity pikselių, todėl i-tasis įdėjimas patenka į krepšį i / bucket_capacity.
+	template<bool FAVOR_OLD>
+	struct age_frontier {
+		// Member objects
+	private:
+		static constexpr uint32_t bucket_count = 1024;
+
+		bucket_sampler sampler;
+		uint32_t bucket_capacity, pushes = 0;
+
+
+
+		// Member functions
+	public:
+		static constexpr uint64_t policy = uint64_t{5} << 32 | FAVOR_OLD;
+
+		static constexpr size_t footprint(const uint32_t capacity) {
+			return bucket_sampler::footprint(bucket_count, (capacity + bucket_count - 1) / bucket_count);
+		}
+
+		constexpr bool init(const uint32_t capacity, arena & memory) & {
+			bucket_capacity = (capacity + bucket_count - 1) / bucket_count;
+			pushes = 0;
+			return sampler.init(bucket_count, bucket_capacity, memory, [](const uint32_t bucket) static {
+				return (FAVOR_OLD ? (bucket_count - bucket) : (bucket + 1));
+			});
+		}
+
+		constexpr bool empty() const & {
+			return sampler.empty();
+		}
+
+		constexpr void clear() & {
+			pushes = 0;
+			sampler.clear();
+		}
+
+		constexpr void push(const uint32_t index, const bool) & {
+			sampler.push(pushes++ / bucket_capacity, index);
+		}
+
+		template<class R>
+		constexpr uint32_t pop(R && rand) & {
+			const uint32_t index = sampler.pop(rand);
+			if (sampler.empty()) pushes = 0;
+			return index;
+		}
+
+		template<class F>
+		constexpr void visit_state(F && f) & {
+			f(&pushes, 1);
+			sampler.visit_state(f);
+		}
+	};
+}
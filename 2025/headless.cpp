@@ -0,0 +1,115 @@
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../AA/include/AA/container/managed.hpp"
+#include "../common/random.hpp"
+#include "../common/trace.hpp"
+#include "engine.hpp"
+#include "mask_source.hpp"
+#include "video_recorder.hpp"
+#include "utils.hpp"
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <SDL3_image/SDL_image.h>
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+
+// Usage: headless <width> <height> <output.png> [threads [seed [video [pixels_per_frame]]]] [--font=<ttf> | --mask=<image>].
+// Su tuo pačiu seed ir viena gija paveikslas visada tas pats. Neatidaro lango ir nekuria renderer, todėl veikia ir be ekrano ar GPU.
+// Kaukė – užrašas šriftu (numatytas yra tik Windows'e) arba paveikslas, kurio ne juodi pikseliai yra tekstas (žr. mask_source.hpp).
+// video – augimo įrašas: *.y4m failas YUV4MPEG2 formatu, kitaip (ir "-" – į stdout) neapdoroti RGBA kadrai.
+// Numatytai kadras įrašomas kas width * height / 600 pikselių, t. y. apie 10 s esant 60 kadrų per sekundę.
+// Jei output baigiasi .tiles, pikseliai laikomi tame faile (žr. mapped_canvas.hpp) ir jis pats yra rezultatas, PNG nekuriamas.
+// Taip galima auginti paveikslus, netelpančius į RAM, pvz., 16384x16384.
+// PNG auginant viena gija be video, kas 5 s įrašomas kontrolinis taškas <output>.checkpoint (žr. checkpoint.hpp). Jei procesas
+// nutraukiamas, ta pati komanda tęsia nuo jo ir gaunamas tas pats paveikslas. Sėkmingai įrašius PNG, failas ištrinamas.
+// Jei failas netinka (kiti matmenys ar kaukė, arba nutraukta dar prieš pirmą tašką), auginama iš naujo ir jis perrašomas.
+int main(const int argc, char ** const argv) {
+	static constexpr std::string_view display_text = "Ačiū"sv;
+
+	mask_source source;
+	const std::vector<std::string_view> args = source.parse(argc, argv);
+	const size_t count = args.size();
+	if (E<error_kind::bad_argv>(count >= 4 && count <= 8)) return EXIT_FAILURE;
+
+	const auto parse = [](const std::string_view arg) static -> uint32_t {
+		uint32_t value = 0;
+		const auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+		return ((ec == std::errc{} && ptr == arg.data() + arg.size()) ? value : 0);
+	};
+	const uint32_t width = parse(args[1]), height = parse(args[2]),
+		thread_count = ((count >= 5) ? parse(args[4]) : aa::unsign(SDL_GetNumLogicalCPUCores())),
+		pixels_per_frame = ((count == 8) ? parse(args[7]) : std::ranges::max(width * height / 600, 1u));
+	if (E<error_kind::bad_argv>(width && height && thread_count && pixels_per_frame)) return EXIT_FAILURE;
+	const uint64_t seed = rng::parse_seed((count >= 6) ? std::optional<std::string_view>{args[5]} : std::nullopt);
+	// argv eilutės baigiasi nuliu, todėl jų data() tinka SDL ir failų funkcijoms.
+	const char * const output_path = args[3].data();
+
+	alignas(engine) constinit static std::array<std::byte, sizeof(engine)> buffer;
+	engine & generator = *std::ranges::construct_at(std::bit_cast<engine *>(buffer.data()));
+	const bool is_tiled = args[3].ends_with(".tiles"), is_checkpointed = (count < 7 && thread_count == 1 && !is_tiled);
+	const std::string checkpoint_path = std::string{args[3]} + ".checkpoint";
+
+	// Kaukės paviršiai reikalingi tik init(), dideliems paveikslams jie užima daugiau nei pats variklis.
+	{
+		// SDL_CreateSurface užpildo pikselius nuliais, todėl fonas juodas.
+		const aa::managed<SDL_Surface *, SDL_DestroySurface> canvas =
+			SDL_CreateSurface(aa::sign(width), aa::sign(height), SDL_PixelFormat::SDL_PIXELFORMAT_XRGB8888);
+		if (E(canvas.has_ownership())) return EXIT_FAILURE;
+
+		if (!source.draw(canvas, display_text)) return EXIT_FAILURE;
+
+		const aa::managed<SDL_Surface *, SDL_DestroySurface> is_text_srf =
+			SDL_ConvertSurface(canvas, SDL_PixelFormat::SDL_PIXELFORMAT_RGB332);
+		if (E(is_text_srf.has_ownership())) return EXIT_FAILURE;
+		if (E<error_kind::bad_file>(generator.init(width, height, std::bit_cast<uint8_t *>(is_text_srf->pixels),
+			aa::unsign(is_text_srf->pitch), (is_tiled ? output_path : nullptr)))) return EXIT_FAILURE;
+	}
+
+	if (count >= 7) {
+		const std::string_view video_path = args[6];
+		const std::unique_ptr recorder = std::make_unique<video_recorder<engine>>();
+		if (E<error_kind::bad_file>(recorder->start(generator, video_path.data(),
+			(video_path.ends_with(".y4m") ? video_format::y4m : video_format::rgba), pixels_per_frame))) return EXIT_FAILURE;
+
+		if (thread_count == 1)	generator.grow(seed, *recorder);
+		else					generator.grow_parallel(thread_count, seed, *recorder);
+		if (E<error_kind::bad_file>(recorder->finish())) return EXIT_FAILURE;
+	} else if (is_checkpointed) {
+		if (generator.can_resume(checkpoint_path.data())) {
+			if (E<error_kind::bad_file>(generator.resume(checkpoint_path.data(), 5s))) return EXIT_FAILURE;
+		} else {
+			if (E<error_kind::bad_file>(generator.grow_checkpointed(seed, checkpoint_path.data(), 5s))) return EXIT_FAILURE;
+		}
+	} else {
+		if (thread_count == 1)	generator.grow(seed);
+		else					generator.grow_parallel(thread_count, seed);
+	}
+
+
+	if (is_tiled) {
+		if (E<error_kind::bad_file>(generator.flush())) return EXIT_FAILURE;
+	} else {
+		const aa::managed<SDL_Surface *, SDL_DestroySurface> image =
+			SDL_CreateSurface(aa::sign(width), aa::sign(height), SDL_PixelFormat::SDL_PIXELFORMAT_ARGB8888);
+		if (E(image.has_ownership())) return EXIT_FAILURE;
+		generator.copy_rows(0, height, static_cast<uint32_t *>(image->pixels), aa::unsign(image->pitch / 4));
+		if (E(IMG_SavePNG(image, output_path))) return EXIT_FAILURE;
+		if (is_checkpointed) std::remove(checkpoint_path.data());
+	}
+
+	if (E<error_kind::bad_file>(trace::finish("trace.json"))) return EXIT_FAILURE;
+
+	std::ranges::destroy_at(&generator);
+	while (TTF_WasInit()) {
+		TTF_Quit();
+	}
+	return EXIT_SUCCESS;
+}
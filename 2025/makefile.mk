@@ -1,7 +1,7 @@
-TARGETS := main
+TARGETS := main headless farm bench
 
 include ~/maker/variables.mk
 
-OPTIONS := $(OPTIONS) -mwindows -lSDL3 -lSDL3_ttf -lstdc++exp
+OPTIONS := $(OPTIONS) -mwindows -lSDL3 -lSDL3_ttf -lSDL3_image -lstdc++exp
 
 include ~/maker/rules.mk
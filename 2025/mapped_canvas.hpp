@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../common/mapped_file.hpp"
+#include "tiled_layout.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+
+
+namespace {
+	// Failo pradžia. Po jos, nuo data_offset, eina visos plytelės tiled_layout tvarka (su border_tiles pločio rėmu),
+	// plytelės viduje eilutės po tile_side pikselių, kiekvienas pikselis – ARGB uint32_t (little-endian). Rėmo pikseliai neturi reikšmės.
+	struct canvas_header {
+		std::array<char, 8> magic = {'A', 'A', 'T', 'I', 'L', 'E', 'S', '1'};
+		uint32_t width, height, tile_side, tiles_x, tiles_y, border_tiles;
+		uint64_t data_offset;
+	};
+
+	// Paveikslas, kurio pikseliai laikomi faile, o ne RAM, ir kartu yra rezultatas (žr. canvas_header). Kaukė užima tik bitą
+	// pikseliui, todėl lieka atmintyje. Kai visi puslapio pikseliai nuspalvinti, puslapis atvėsinamas, todėl atmintyje
+	// daugiausia lieka plytelės aplink kraštą.
+	struct mapped_canvas {
+		// Member objects
+	private:
+		static constexpr size_t page_size = 4096, page_pixels = page_size / sizeof(uint32_t);
+
+		mapped_file pixel_file;
+		// Kiek dar nenuspalvintų pikselių liko kiekviename puslapyje.
+		std::unique_ptr<uint16_t[]> remaining;
+		uint32_t pixel_count, page_count;
+
+		constexpr void retire(const uint32_t page) const & {
+			pixel_file.cool(page_size + size_t{page} * page_size, page_size);
+		}
+
+
+
+		// Member functions
+	public:
+		constexpr bool open(const char * const path, const tiled_layout & layout) & {
+			pixel_count = layout.size();
+			page_count = aa::cast<uint32_t>((pixel_count + page_pixels - 1) / page_pixels);
+			if (!pixel_file.open(path, page_size + size_t{page_count} * page_size, false)) return false;
+
+			const canvas_header header = {
+				.width = layout.get_width(), .height = layout.get_height(), .tile_side = tiled_layout::side,
+				.tiles_x = layout.get_tiles_x(), .tiles_y = layout.get_tiles_y(), .border_tiles = 1, .data_offset = page_size
+			};
+			std::memcpy(pixel_file.data(), &header, sizeof(header));
+
+			remaining = std::make_unique<uint16_t[]>(page_count);
+			return remaining != nullptr;
+		}
+
+		constexpr void close() & {
+			pixel_file.close();
+			remaining.reset();
+		}
+
+		constexpr bool is_open() const & { return pixel_file.is_open(); }
+
+		constexpr uint32_t * get_pixels() const & { return std::bit_cast<uint32_t *>(pixel_file.data() + page_size); }
+
+		// Kviečiama po to, kai pikseliai užpildyti nuliais (paveikslas) ir rėmu. Visas failas ką tik perrašytas, todėl atvėsinamas.
+		constexpr void reset() & {
+			const uint32_t * const pixels = get_pixels();
+			for (uint32_t page = 0; page != page_count; ++page) {
+				remaining[page] = aa::cast<uint16_t>(std::ranges::count(pixels + size_t{page} * page_pixels,
+					pixels + std::ranges::min(size_t{page + 1} * page_pixels, size_t{pixel_count}), 0u));
+			}
+			pixel_file.cool(page_size, size_t{page_count} * page_size);
+		}
+
+		// Pikselis index (tiled_layout) nuspalvintas galutinai.
+		constexpr void claim(const uint32_t index) & {
+			if (!--remaining[index / page_pixels]) retire(index / page_pixels);
+		}
+
+		constexpr void claim_atomic(const uint32_t index) & {
+			if (std::atomic_ref{remaining[index / page_pixels]}.fetch_sub(1, std::memory_order::relaxed) == 1) retire(index / page_pixels);
+		}
+
+		constexpr bool flush() const & { return pixel_file.flush(); }
+	};
+}
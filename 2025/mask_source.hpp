@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "../AA/include/AA/container/managed.hpp"
+#include "utils.hpp"
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <SDL3_image/SDL_image.h>
+
+#include <string_view>
+#include <vector>
+
+
+
+namespace {
+	// Iš kur imama teksto kaukė programoms be lango: užrašas šriftu font arba paveikslas image, kurio ne juodi pikseliai
+	// yra tekstas (ištempiamas iki paveikslo dydžio). Numatytas šriftas yra tik Windows'e, todėl kitur reikia --font arba --mask.
+	struct mask_source {
+		static constexpr std::string_view default_font = "C:\\Windows\\Fonts\\Ruler Stencil Heavy.ttf";
+
+		std::string_view font = default_font, image;
+
+		// Išima --font=<ttf> ir --mask=<paveikslas> iš bet kurios argv vietos. Grąžina likusius argumentus, pirmas – programos vardas.
+		constexpr std::vector<std::string_view> parse(const int argc, const char * const * const argv) & {
+			std::vector<std::string_view> positional;
+			for (int i = 0; i != argc; ++i) {
+				const std::string_view arg = argv[i];
+				/**/ if (arg.starts_with("--font="))	font = arg.substr(7);
+				else if (arg.starts_with("--mask="))	image = arg.substr(7);
+				else									positional.push_back(arg);
+			}
+			return positional;
+		}
+
+		// Nupiešia kaukę ant juodo canvas. Šriftas atidaromas ir uždaromas čia, TTF_Quit() – kvietėjo reikalas.
+		constexpr bool draw(SDL_Surface * const canvas, const std::string_view text) const & {
+			if (!image.empty()) {
+				const aa::managed<SDL_Surface *, SDL_DestroySurface> picture = IMG_Load(image.data());
+				if (E(picture.has_ownership())) return false;
+				return !E(SDL_BlitSurfaceScaled(picture, nullptr, canvas, nullptr, SDL_ScaleMode::SDL_SCALEMODE_NEAREST));
+			}
+
+			if (E(TTF_Init())) return false;
+			const aa::managed<TTF_Font *, TTF_CloseFont> ttf = TTF_OpenFont(font.data(), 980);
+			if (E<error_kind::bad_font>(ttf.has_ownership())) return false;
+
+			const aa::managed<SDL_Surface *, SDL_DestroySurface> rendered =
+				TTF_RenderText_Solid(ttf, text.data(), text.size(), {255, 255, 255, SDL_ALPHA_OPAQUE});
+			if (E(rendered.has_ownership())) return false;
+
+			const std::optional bbox = get_text_bbox(ttf, text);
+			if (E(bbox.has_value())) return false;
+
+			return !E(SDL_BlitSurface(rendered, &*bbox, canvas, &aa::stay(SDL_Rect{
+				(canvas->w - bbox->w) / 2,
+				(canvas->h - bbox->h) / 2, 0, 0})));
+		}
+	};
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+
+#include <atomic>
+#include <optional>
+
+
+
+namespace {
+	// Auginimo gijos valdymas iš pagrindinės gijos: paleisti iš naujo su kitu seed, pristabdyti, baigti. Visa būsena viename
+	// atominiame žodyje, todėl gija ją tikrina vienu nuskaitymu (žr. interrupted()), o laukia per std::atomic::wait be semaforų.
+	struct run_control {
+		// Member objects
+	private:
+		// Du žemiausi bitai – vėliavos, likę – paleidimo numeris, kuris didėja su kiekvienu restart().
+		static constexpr uint32_t paused = 1, quitting = 2, flags = paused | quitting, one_run = 4;
+
+		std::atomic<uint32_t> word = 0;
+		std::atomic<uint64_t> next_seed = 0;
+
+
+
+		// Member functions
+		template<class F>
+		constexpr uint32_t update(F && f) & {
+			uint32_t w = word.load(std::memory_order::relaxed);
+			while (!word.compare_exchange_weak(w, f(w), std::memory_order::release, std::memory_order::relaxed));
+			word.notify_all();
+			return f(w);
+		}
+
+	public:
+		// Pagrindinė gija. Nutraukia vykstantį auginimą (jei yra) ir pradeda naują su seed, pauzė nuimama.
+		// Grąžina naujo paleidimo numerį, kurį gija perduoda atgal su pabaigos pranešimu.
+		constexpr uint32_t restart(const uint64_t seed) & {
+			next_seed.store(seed, std::memory_order::relaxed);
+			return update([](const uint32_t w) static -> uint32_t { return ((w & ~flags) + one_run) | (w & quitting); }) & ~flags;
+		}
+
+		constexpr void toggle_pause() & {
+			update([](const uint32_t w) static -> uint32_t { return w ^ paused; });
+		}
+
+		constexpr void quit() & {
+			update([](const uint32_t w) static -> uint32_t { return w | quitting; });
+		}
+
+		constexpr bool is_paused() const & {
+			return word.load(std::memory_order::relaxed) & paused;
+		}
+
+		// Auginimo gija. Laukia paleidimo, naujesnio nei run, ir grąžina jo seed; nullopt – reikia baigti.
+		constexpr std::optional<uint64_t> wait_for_run(uint32_t & run) const & {
+			uint32_t w = word.load(std::memory_order::acquire);
+			while (!(w & quitting) && (w & ~flags) == run) {
+				word.wait(w, std::memory_order::acquire);
+				w = word.load(std::memory_order::acquire);
+			}
+			if (w & quitting) return std::nullopt;
+			run = w & ~flags;
+			return next_seed.load(std::memory_order::relaxed);
+		}
+
+		// Auginimo gija, kas kelis šimtus pikselių. Kol pristabdyta, laukia; true – paleidimas run nebeaktualus, reikia grįžti.
+		constexpr bool interrupted(const uint32_t run) const & {
+			uint32_t w = word.load(std::memory_order::acquire);
+			while ((w & flags) == paused && (w & ~flags) == run) {
+				word.wait(w, std::memory_order::acquire);
+				w = word.load(std::memory_order::acquire);
+			}
+			return (w & quitting) || (w & ~flags) != run;
+		}
+	};
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "utils.hpp"
+
+#include <bit>
+#include <span>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+
+// Apvalkalo kandidatų tikrinimas: kandidatas i yra color + offsets[i] (poslinkiai kaip color_shells.hpp).
+// free turi talpinti (offsets.size() + 63) / 64 žodžių; bitas i nustatomas, jei kandidatas yra RGB kube
+// ir jo bitas used masyve lygus 0. Versija parenkama vieną kartą pagal procesorių.
+namespace {
+	constexpr uint32_t add_offset(const uint32_t color, const uint32_t offset) {
+		return
+			((red(color) + aa::cast<uint32_t>(aa::cast<int8_t>(red(offset)))) << 16) |
+			((green(color) + aa::cast<uint32_t>(aa::cast<int8_t>(green(offset)))) << 8) |
+			((blue(color) + aa::cast<uint32_t>(aa::cast<int8_t>(blue(offset)))) << 0);
+	}
+
+	// load(i) – i-asis used žodis.
+	template<class L>
+	constexpr void shell_free_scalar(L && load, const uint32_t color, const std::span<const uint32_t> offsets, uint64_t * const free) {
+		for (size_t i = 0; i != offsets.size(); ++i) {
+			const uint32_t
+				r = red(color) + aa::cast<uint32_t>(aa::cast<int8_t>(red(offsets[i]))),
+				g = green(color) + aa::cast<uint32_t>(aa::cast<int8_t>(green(offsets[i]))),
+				b = blue(color) + aa::cast<uint32_t>(aa::cast<int8_t>(blue(offsets[i])));
+			if ((r | g | b) > 0xFFu) continue;
+
+			const uint32_t c = ((r << 16) | (g << 8) | (b << 0));
+			if (!((load(c >> 5) >> (c & 31)) & 1u)) free[i / 64] |= uint64_t{1} << (i % 64);
+		}
+	}
+
+#if defined(__x86_64__) || defined(__i386__)
+	[[gnu::target("avx2")]]
+	inline void shell_free_avx2(const uint32_t * const used, const uint32_t color,
+		const std::span<const uint32_t> offsets, uint64_t * const free)
+	{
+		const __m256i
+			r = _mm256_set1_epi32(aa::sign(red(color))),
+			g = _mm256_set1_epi32(aa::sign(green(color))),
+			b = _mm256_set1_epi32(aa::sign(blue(color))),
+			outside = _mm256_set1_epi32(~0xFF),
+			low_bits = _mm256_set1_epi32(31),
+			lane_index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+			zero = _mm256_setzero_si256();
+
+		// Paskutinis vektorius įkeliamas su kauke, kad mažiems apvalkalams nereiktų skaliarinės uodegos.
+		for (size_t i = 0; i < offsets.size(); i += 8) {
+			const __m256i lanes = _mm256_cmpgt_epi32(_mm256_set1_epi32(aa::sign(aa::cast<uint32_t>(offsets.size() - i))), lane_index);
+			const __m256i o = _mm256_maskload_epi32(std::bit_cast<const int *>(offsets.data() + i), lanes);
+			const __m256i
+				nr = _mm256_add_epi32(r, _mm256_srai_epi32(_mm256_slli_epi32(o, 8), 24)),
+				ng = _mm256_add_epi32(g, _mm256_srai_epi32(_mm256_slli_epi32(o, 16), 24)),
+				nb = _mm256_add_epi32(b, _mm256_srai_epi32(_mm256_slli_epi32(o, 24), 24));
+			const __m256i inside = _mm256_and_si256(lanes, _mm256_cmpeq_epi32(
+				_mm256_and_si256(_mm256_or_si256(_mm256_or_si256(nr, ng), nb), outside), zero));
+			const __m256i c = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(nr, 16), _mm256_slli_epi32(ng, 8)), nb);
+
+			// Už kubo ribų esantys kandidatai nerenkami, todėl ir neskaitomi iš atminties.
+			const __m256i w = _mm256_mask_i32gather_epi32(zero, std::bit_cast<const int *>(used), _mm256_srli_epi32(c, 5), inside, 4);
+			const __m256i taken = _mm256_slli_epi32(_mm256_srlv_epi32(w, _mm256_and_si256(c, low_bits)), 31);
+			free[i / 64] |= aa::cast<uint64_t>(aa::unsign(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(taken, inside))))) << (i % 64);
+		}
+	}
+
+	[[gnu::target("avx512f")]]
+	inline void shell_free_avx512(const uint32_t * const used, const uint32_t color,
+		const std::span<const uint32_t> offsets, uint64_t * const free)
+	{
+		const __m512i
+			r = _mm512_set1_epi32(aa::sign(red(color))),
+			g = _mm512_set1_epi32(aa::sign(green(color))),
+			b = _mm512_set1_epi32(aa::sign(blue(color))),
+			outside = _mm512_set1_epi32(~0xFF),
+			low_bits = _mm512_set1_epi32(31),
+			one = _mm512_set1_epi32(1);
+
+		for (size_t i = 0; i < offsets.size(); i += 16) {
+			const __mmask16 lanes = aa::cast<__mmask16>((offsets.size() - i >= 16) ? 0xFFFFu : ((1u << (offsets.size() - i)) - 1));
+			const __m512i o = _mm512_maskz_loadu_epi32(lanes, offsets.data() + i);
+			const __m512i
+				nr = _mm512_add_epi32(r, _mm512_srai_epi32(_mm512_slli_epi32(o, 8), 24)),
+				ng = _mm512_add_epi32(g, _mm512_srai_epi32(_mm512_slli_epi32(o, 16), 24)),
+				nb = _mm512_add_epi32(b, _mm512_srai_epi32(_mm512_slli_epi32(o, 24), 24));
+			const __mmask16 inside = _mm512_mask_testn_epi32_mask(lanes, _mm512_or_si512(_mm512_or_si512(nr, ng), nb), outside);
+			const __m512i c = _mm512_or_si512(_mm512_or_si512(_mm512_slli_epi32(nr, 16), _mm512_slli_epi32(ng, 8)), nb);
+
+			const __m512i w = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), inside, _mm512_srli_epi32(c, 5), used, 4);
+			const __mmask16 taken = _mm512_mask_test_epi32_mask(inside, _mm512_srlv_epi32(w, _mm512_and_si512(c, low_bits)), one);
+			free[i / 64] |= aa::cast<uint64_t>(inside & ~taken & 0xFFFFu) << (i % 64);
+		}
+	}
+#endif
+
+	using shell_free_function = void (*)(const uint32_t *, uint32_t, std::span<const uint32_t>, uint64_t *);
+
+	inline const shell_free_function shell_free_dispatch = [] static -> shell_free_function {
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))	return shell_free_avx512;
+		if (__builtin_cpu_supports("avx2"))		return shell_free_avx2;
+#endif
+		return [](const uint32_t * const used, const uint32_t color, const std::span<const uint32_t> offsets, uint64_t * const free) static -> void {
+			shell_free_scalar([&](const uint32_t i) -> uint32_t { return shared_load<true>(used[i]); }, color, offsets, free);
+		};
+	}();
+
+	// Lygiagrečiai auginant kitos gijos tuo pat metu užiminėja spalvas, todėl surinkimas (gather) gali pamatyti seną žodį.
+	// Tada rezultatas tėra užuomina: laisvu pažymėtą kandidatą vis tiek patvirtina color_set::claim_atomic.
+	constexpr void shell_free(const uint32_t * const used, const uint32_t color,
+		const std::span<const uint32_t> offsets, uint64_t * const free)
+	{
+		std::ranges::fill_n(free, (offsets.size() + 63) / 64, uint64_t{0});
+		if consteval {
+			shell_free_scalar([&](const uint32_t i) -> uint32_t { return used[i]; }, color, offsets, free);
+		} else {
+			shell_free_dispatch(used, color, offsets, free);
+		}
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+
+#include <algorithm>
+#include <functional>
+
+
+
+namespace {
+	// Vidinis variklio išdėstymas: paveikslas suskaidytas į side × side plyteles, plytelės viduje eilutės eina viena po kitos.
+	// Plytelės eilutė (16 uint32_t) užima vieną spartinančiosios atminties eilutę, o vertikalus kaimynas dažniausiai yra
+	// už side elementų, ne už visos paveikslo eilutės. Aplink paveikslą yra vienos plytelės rėmas, todėl kaimynų
+	// indeksai visada patenka į buferį ir ribų tikrinti nereikia – rėmo pikseliai tiesiog laikomi užimtais.
+	struct tiled_layout {
+		// Member objects
+		static constexpr uint32_t shift = 4, side = 1u << shift, tile_size = side * side;
+
+	private:
+		uint32_t width, height, tiles_x, tiles_y;
+
+
+
+		// Member functions
+	public:
+		constexpr void init(const uint32_t w, const uint32_t h) & {
+			width = w;
+			height = h;
+			tiles_x = (width + side - 1) / side + 2;
+			tiles_y = (height + side - 1) / side + 2;
+		}
+
+		constexpr uint32_t get_width() const & { return width; }
+		constexpr uint32_t get_height() const & { return height; }
+		constexpr uint32_t get_tiles_x() const & { return tiles_x; }
+		constexpr uint32_t get_tiles_y() const & { return tiles_y; }
+
+		// Elementų skaičius su rėmu ir nepilnomis plytelėmis.
+		constexpr uint32_t size() const & { return tiles_x * tiles_y * tile_size; }
+
+		constexpr uint32_t index(const uint32_t x, const uint32_t y) const & {
+			const uint32_t px = x + side, py = y + side;
+			return ((py >> shift) * tiles_x + (px >> shift)) * tile_size + ((py & (side - 1)) << shift) + (px & (side - 1));
+		}
+
+		// Atvirkščiai, y * width + x. Dalyba tik iš tiles_x, todėl naudojama ne kaimynų paieškoje.
+		constexpr uint32_t linear(const uint32_t index) const & {
+			const uint32_t tile = index / tile_size;
+			return (((tile / tiles_x) << shift) + ((index >> shift) & (side - 1)) - side) * width
+				+ ((tile % tiles_x) << shift) + (index & (side - 1)) - side;
+		}
+
+		// Keturi kaimynai ta pačia tvarka kaip eilutiniame išdėstyme: kairė, dešinė, viršus, apačia.
+		template<class F>
+		constexpr void for_each_neighbor(const uint32_t index, F && f) const & {
+			const uint32_t x = index & (side - 1), y = (index >> shift) & (side - 1), row_stride = tiles_x * tile_size;
+			f((x != 0)			? index - 1		: index - tile_size + (side - 1));
+			f((x != side - 1)	? index + 1		: index + tile_size - (side - 1));
+			f((y != 0)			? index - side	: index - row_stride + (side - 1) * side);
+			f((y != side - 1)	? index + side	: index + row_stride - (side - 1) * side);
+		}
+
+		// Paveikslo elementai gauna inside, rėmo ir nepilnų plytelių likučiai – outside. store(element, value) įrašo, pvz., atomiškai.
+		template<class T, class S = decltype([](T & element, const T value) static -> void { element = value; })>
+		constexpr void fill(T * const data, const T inside, const T outside, S && store = {}) const & {
+			for (uint32_t py = 0; py != tiles_y * side; ++py) {
+				const bool row_inside = py - side < height;
+				T * row = data + (py >> shift) * tiles_x * tile_size + ((py & (side - 1)) << shift);
+				for (uint32_t px = 0; px != tiles_x * side; px += side, row += tile_size) {
+					for (uint32_t x = 0; x != side; ++x) store(row[x], ((row_inside && px + x - side < width) ? inside : outside));
+				}
+			}
+		}
+
+		// Eilutinis buferis (pitch elementų tarp eilučių) į išdėstymą. Rėmas nekeičiamas.
+		template<class T>
+		constexpr void copy_from_linear(const T * const in, const size_t pitch, T * const data) const & {
+			for (uint32_t y = 0; y != height; ++y) {
+				const T * const from = in + y * pitch;
+				for (uint32_t x = 0; x < width; x += side) {
+					std::ranges::copy_n(from + x, std::ranges::min(side, width - x), data + index(x, y));
+				}
+			}
+		}
+
+		// Eilutės [first_row, first_row + row_count) į eilutinį buferį, out rodo į first_row pradžią. f pritaikoma kiekvienam elementui.
+		template<class T, class F = std::identity>
+		constexpr void copy_to_linear(const T * const data, const uint32_t first_row, const uint32_t row_count,
+			T * const out, const size_t pitch, F && f = {}) const &
+		{
+			for (uint32_t y = 0; y != row_count; ++y) {
+				T * const to = out + y * pitch;
+				for (uint32_t x = 0; x < width; x += side) {
+					const T * const from = data + index(x, first_row + y);
+					std::ranges::transform(from, from + std::ranges::min(side, width - x), to + x, f);
+				}
+			}
+		}
+	};
+}
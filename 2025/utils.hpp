@@ -5,6 +5,7 @@
 #include <SDL3/SDL.h>
 #include <SDL3_ttf/SDL_ttf.h>
 
+#include <atomic>
 #include <print>
 #include <source_location>
 
@@ -22,6 +23,14 @@ constexpr uint32_t blue(const uint32_t c) {
 	return ((c >> 0)	& 0xFFu);
 }
 
+// Skaitymas duomenų, kuriuos kai SHARED kitos gijos tuo pat metu keičia per std::atomic_ref: tada ir skaitoma atomiškai.
+// Patys objektai ne const (jie arenoje), const čia tik todėl, kad skaitoma iš const funkcijų.
+template<bool SHARED, class T>
+constexpr T shared_load(const T & value) {
+	if constexpr (SHARED)	return std::atomic_ref{const_cast<T &>(value)}.load(std::memory_order::relaxed);
+	else					return value;
+}
+
 template<std::integral X>
 constexpr X random(const X x) {
 	return aa::sign_cast<X>(SDL_rand(aa::sign_cast<int32_t>(x)));
@@ -68,6 +77,8 @@ enum struct error_kind : size_t {
 	bad_argv,
 	bad_data,
 	bad_color,
+	bad_file,
+	bad_font,
 	bad_thread,
 	info
 };
@@ -85,6 +96,8 @@ constexpr bool E(const bool cond,
 		else if constexpr (ERROR == error_kind::bad_log)		SDL_SetError("%s", "Could not open the log file");
 		else if constexpr (ERROR == error_kind::bad_data)		SDL_SetError("%s", "Data is incorrect");
 		else if constexpr (ERROR == error_kind::bad_color)		SDL_SetError("%s", "Failed to find a valid color");
+		else if constexpr (ERROR == error_kind::bad_file)		SDL_SetError("%s", "Could not write the output file");
+		else if constexpr (ERROR == error_kind::bad_font)		SDL_SetError("%s", "Could not open the font, pass --font=<file.ttf> or --mask=<image>");
 		else if constexpr (ERROR == error_kind::bad_thread)		SDL_SetError("%s", "Thread failed");
 		else if constexpr (ERROR == error_kind::info)			SDL_SetError("%s", "Nothing happened");
 
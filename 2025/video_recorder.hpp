@@ -0,0 +1,212 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+#include "dirty_rows.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <print>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+
+namespace {
+	// y4m – YUV4MPEG2 su 4:4:4 BT.601 (ffmpeg, mpv ir kt. skaito tiesiai), rgba – R, G, B, A baitai be antraštės.
+	enum struct video_format : uint8_t { y4m, rgba };
+
+	// Auginimo įrašymas. Engine stebėtojas: kas frame_pixels nuspalvintų pikselių auginimo gija nukopijuoja tik nuo praeito
+	// kadro pakitusias eilutes, o kadras sudedamas, koduojamas ir rašomas atskiroje gijoje. Jei rašymas atsilieka daugiau nei
+	// max_queued_bytes, kadras praleidžiamas ir jo eilutės patenka į kitą, todėl auginimas niekada nelaukia disko.
+	template<class ENGINE>
+	struct video_recorder {
+		// Member objects
+	private:
+		static constexpr uint32_t frame_rate = 60;
+
+		struct frame {
+			std::vector<std::pair<uint32_t, uint32_t>> runs;
+			std::vector<uint32_t> pixels;
+		};
+
+		const ENGINE * source;
+		std::FILE * file = nullptr;
+		video_format format;
+		// claimed didinamas po batch_pixels, kad gijos nesidalintų vienu skaitikliu kiekvienam pikseliui.
+		uint32_t width, height, frame_pixels, batch_pixels;
+		size_t max_queued_bytes;
+
+		dirty_rows dirty;
+		std::atomic<uint64_t> claimed;
+		std::atomic<size_t> queued_bytes, dropped;
+		std::atomic<bool> failed;
+		std::mutex capture_lock;
+
+		std::mutex queue_lock;
+		std::condition_variable queue_ready;
+		std::deque<frame> queue;
+		bool is_closing;
+
+		// Paskutinis, kad būtų sustabdytas pirmiau nei sunaikinama eilė.
+		std::jthread writer;
+
+
+
+		// Member functions
+		constexpr void capture(const bool force) & {
+			const std::scoped_lock guard = std::scoped_lock{capture_lock};
+			if (!force && queued_bytes.load(std::memory_order::relaxed) > max_queued_bytes) {
+				dropped.fetch_add(1, std::memory_order::relaxed);
+				return;
+			}
+
+			frame f;
+			dirty.consume([&](const uint32_t first_row, const uint32_t row_count) -> void {
+				const size_t offset = f.pixels.size();
+				f.runs.emplace_back(first_row, row_count);
+				f.pixels.resize(offset + size_t{row_count} * width);
+				source->copy_rows(first_row, row_count, f.pixels.data() + offset, width);
+			});
+			queued_bytes.fetch_add(f.pixels.size() * sizeof(uint32_t), std::memory_order::relaxed);
+
+			{
+				const std::scoped_lock queue_guard = std::scoped_lock{queue_lock};
+				queue.emplace_back(std::move(f));
+			}
+			queue_ready.notify_one();
+		}
+
+		constexpr void encode(const std::vector<uint32_t> & canvas, std::vector<uint8_t> & out) const & {
+			out.clear();
+			switch (format) {
+			case video_format::y4m: {
+				static constexpr std::string_view tag = "FRAME\n";
+				out.insert(out.end(), tag.begin(), tag.end());
+				const size_t plane = canvas.size(), start = out.size();
+				out.resize(start + 3 * plane);
+				uint8_t * const y = out.data() + start, * const u = y + plane, * const v = u + plane;
+				for (size_t i = 0; i != plane; ++i) {
+					const int32_t r = aa::sign(red(canvas[i])), g = aa::sign(green(canvas[i])), b = aa::sign(blue(canvas[i]));
+					y[i] = aa::cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+					u[i] = aa::cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+					v[i] = aa::cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+				}
+			} break;
+
+			case video_format::rgba:
+				out.resize(4 * canvas.size());
+				for (size_t i = 0; i != canvas.size(); ++i) {
+					out[4 * i + 0] = aa::cast<uint8_t>(red(canvas[i]));
+					out[4 * i + 1] = aa::cast<uint8_t>(green(canvas[i]));
+					out[4 * i + 2] = aa::cast<uint8_t>(blue(canvas[i]));
+					out[4 * i + 3] = 0xFF;
+				}
+			}
+		}
+
+		constexpr void write_frames() & {
+			std::vector<uint32_t> canvas = std::vector<uint32_t>(size_t{width} * height, 0u);
+			std::vector<uint8_t> encoded;
+
+			while (true) {
+				frame f;
+				{
+					std::unique_lock guard = std::unique_lock{queue_lock};
+					queue_ready.wait(guard, [&] -> bool { return is_closing || !queue.empty(); });
+					if (queue.empty()) return;
+					f = std::move(queue.front());
+					queue.pop_front();
+				}
+
+				const uint32_t * from = f.pixels.data();
+				for (const auto [first_row, row_count] : f.runs) {
+					from = std::ranges::copy_n(from, size_t{row_count} * width, canvas.data() + size_t{first_row} * width).in;
+				}
+				queued_bytes.fetch_sub(f.pixels.size() * sizeof(uint32_t), std::memory_order::relaxed);
+
+				// Po klaidos eilė vis tiek tuštinama, kad capture() neužstrigtų ties max_queued_bytes.
+				if (failed.load(std::memory_order::relaxed)) continue;
+				encode(canvas, encoded);
+				if (std::fwrite(encoded.data(), 1, encoded.size(), file) != encoded.size())
+					failed.store(true, std::memory_order::relaxed);
+			}
+		}
+
+	public:
+		constexpr video_recorder() = default;
+		video_recorder(const video_recorder &) = delete;
+		video_recorder & operator=(const video_recorder &) = delete;
+		constexpr ~video_recorder() { finish(); }
+
+		// path "-" reiškia stdout, kitaip atidaromas failas (ar vardinis kanalas). engine turi būti inicializuotas ir gyvuoti iki finish().
+		constexpr bool start(const ENGINE & engine, const char * const path, const video_format f,
+			const uint32_t pixels_per_frame, const uint32_t queued_frames = 16) &
+		{
+			if (file || !pixels_per_frame) return false;
+
+			source = &engine;
+			format = f;
+			width = engine.get_width();
+			height = engine.get_height();
+			frame_pixels = pixels_per_frame;
+			batch_pixels = std::ranges::clamp(pixels_per_frame / 16, 1u, 256u);
+			max_queued_bytes = size_t{queued_frames} * width * height * sizeof(uint32_t);
+			claimed = 0;
+			queued_bytes = dropped = 0;
+			failed = is_closing = false;
+			if (!dirty.init(width, height)) return false;
+
+			file = ((std::string_view{path} == "-") ? stdout : std::fopen(path, "wb"));
+			if (!file) return false;
+			if (format == video_format::y4m)
+				std::print(file, "YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C444\n", width, height, frame_rate);
+
+			writer = std::jthread{[this] -> void { write_frames(); }};
+			return true;
+		}
+
+		// Engine stebėtojas, kviečiamas iš bet kurios auginimo gijos. Kiekviena gija pikselius skaičiuoja pati ir į claimed prideda
+		// po batch_pixels, todėl kadras gali vėluoti ne daugiau nei batch_pixels pikselių kiekvienai gijai (iki 1/16 kadro).
+		// Nepridėti likučiai nesvarbūs: finish() vis tiek įrašo paskutinį kadrą.
+		constexpr void on_pixel(const uint32_t index) & {
+			dirty.on_pixel(index);
+
+			thread_local const video_recorder * owner = nullptr;
+			thread_local uint32_t local = 0;
+			if (owner != this) owner = this, local = 0;
+			if (++local != batch_pixels) return;
+			local = 0;
+
+			const uint64_t before = claimed.fetch_add(batch_pixels, std::memory_order::relaxed);
+			if (before / frame_pixels != (before + batch_pixels) / frame_pixels) capture(false);
+		}
+
+		// Įrašo paskutinį kadrą, laukia, kol viskas bus parašyta, ir uždaro failą. false, jei kažko nepavyko parašyti.
+		constexpr bool finish() & {
+			if (!file) return true;
+
+			capture(true);
+			{
+				const std::scoped_lock guard = std::scoped_lock{queue_lock};
+				is_closing = true;
+			}
+			queue_ready.notify_one();
+			writer.join();
+
+			if (std::fflush(file)) failed = true;
+			if (file != stdout && std::fclose(file)) failed = true;
+			file = nullptr;
+			return !failed;
+		}
+
+		// Kadrai, praleisti dėl atsiliekančio rašymo.
+		constexpr size_t get_dropped_frames() const & { return dropped.load(std::memory_order::relaxed); }
+	};
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#ifdef _WIN32
+// Kitaip windows.h apibrėžia min ir max makrokomandas, kurios sugadina std::ranges::min(...).
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <charconv>
+#include <initializer_list>
+#include <print>
+#include <string_view>
+#include <utility>
+
+
+
+// Bendri matavimo įrankiai kiekvienų metų bench programoms. Rezultatai spausdinami į stdout kaip vienas JSON masyvas.
+namespace bench {
+	struct resolution {
+		uint32_t width, height;
+		std::string_view name;
+	};
+
+	inline constexpr std::array resolutions = std::to_array<resolution>({
+		{1920, 1080, "1080p"},
+		{3840, 2160, "4K"},
+		{4096, 4096, "4096x4096"}
+	});
+
+	inline constexpr uint64_t default_seed = 2025;
+
+	// Vietoje teksto naudojama elipsė, kad matavimams nereikėtų šrifto ir lango.
+	constexpr bool in_mask(const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height) {
+		const double dx = (x - width * 0.5) / (width * 0.35), dy = (y - height * 0.5) / (height * 0.25);
+		return (dx * dx + dy * dy) <= 1.0;
+	}
+
+	// Pradeda naują peak_rss() matavimą, kad kiekvienas įrašas rodytų tik savo branduolio maksimumą.
+	// Linux'e maksimumas (VmHWM) atstatomas iki dabartinio RSS per /proc/self/clear_refs. Kitur to padaryti negalima.
+	inline void reset_peak_rss() {
+#ifdef __linux__
+		if (std::FILE * const file = std::fopen("/proc/self/clear_refs", "w")) {
+			std::fputs("5", file);
+			std::fclose(file);
+		}
+#endif
+	}
+
+	// Linux'e – VmHWM nuo paskutinio reset_peak_rss(). Windows'e – didžiausias darbinis rinkinys, kitur – ru_maxrss: ten tai
+	// viso proceso maksimumas, todėl branduolius palyginti galima tik matuojant po vieną raišką atskiruose paleidimuose.
+	inline uint64_t peak_rss() {
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+		return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+#elif defined(__linux__)
+		std::FILE * const file = std::fopen("/proc/self/status", "r");
+		if (!file) return 0;
+		std::array<char, 256> line;
+		unsigned long long kilobytes = 0;
+		while (std::fgets(line.data(), line.size(), file) && std::sscanf(line.data(), "VmHWM: %llu kB", &kilobytes) != 1);
+		std::fclose(file);
+		return static_cast<uint64_t>(kilobytes) * 1024;
+#else
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+	}
+
+	struct stopwatch {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		// Sekundės nuo paskutinio lap() arba sukūrimo.
+		double lap() & {
+			const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			return std::chrono::duration<double>(now - std::exchange(start, now)).count();
+		}
+	};
+
+	struct value {
+		std::string_view name;
+		double amount;
+	};
+
+	struct report {
+		bool first = true;
+
+		report() {
+			std::print("[");
+			reset_peak_rss();
+		}
+		~report() { std::println("\n]"); }
+
+		// peak_rss_bytes apima laiką nuo ankstesnio įrašo, todėl tarp įrašų reikia atlaisvinti ankstesnio branduolio atmintį.
+		void record(const std::string_view project, const std::string_view kernel, const resolution & r, const uint64_t seed,
+			const std::initializer_list<value> phases, const std::initializer_list<value> rates) &
+		{
+			std::print("{}\n\t{{\"project\": \"{}\", \"kernel\": \"{}\", \"resolution\": \"{}\", \"width\": {}, \"height\": {}, \"seed\": {}",
+				(std::exchange(first, false) ? "" : ","), project, kernel, r.name, r.width, r.height, seed);
+
+			const auto print_object = [](const std::string_view name, const std::initializer_list<value> values) static -> void {
+				std::print(", \"{}\": {{", name);
+				bool first_value = true;
+				for (const auto & [key, amount] : values) {
+					std::print("{}\"{}\": ", (std::exchange(first_value, false) ? "" : ", "), key);
+					// Pvz., per 0 s trukusio etapo sparta. JSON neturi begalybės ir NaN.
+					if (std::isfinite(amount))	std::print("{}", amount);
+					else						std::print("null");
+				}
+				std::print("}}");
+			};
+			print_object("phases_seconds", phases);
+			print_object("rates", rates);
+			std::print(", \"peak_rss_bytes\": {}}}", peak_rss());
+			reset_peak_rss();
+		}
+	};
+
+	// Usage: bench [width height [seed]]. Be argumentų matuojamos visos standartinės raiškos.
+	template<class F>
+	int run(const int argc, const char * const * const argv, F && f) {
+		const auto parse = [](const std::string_view arg) static -> uint64_t {
+			uint64_t number = 0;
+			const auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), number);
+			return ((ec == std::errc{} && ptr == arg.data() + arg.size()) ? number : 0);
+		};
+
+		report out;
+		switch (argc) {
+		case 1:
+			for (const resolution & r : resolutions) f(out, r, default_seed);
+			return EXIT_SUCCESS;
+
+		case 3: case 4: {
+			const resolution r = {static_cast<uint32_t>(parse(argv[1])), static_cast<uint32_t>(parse(argv[2])), "custom"};
+			if (!r.width || !r.height) return EXIT_FAILURE;
+			f(out, r, ((argc == 4) ? parse(argv[3]) : default_seed));
+			return EXIT_SUCCESS;
+		}
+
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+}
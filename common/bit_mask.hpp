@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+
+
+// Vienas bitas kiekvienam elementui, bendras visų metų programoms (pvz., teksto kaukė). Kaip std::span, tik rodo į
+// svetimus 64 bitų žodžius (arena, fixed_array), todėl kopijuojamas pigiai ir set() nekeičia paties objekto.
+struct bit_mask {
+	uint64_t * words = nullptr;
+
+	static constexpr size_t word_count(const size_t bits) {
+		return (bits + 63) / 64;
+	}
+
+	constexpr bool test(const size_t i) const & {
+		return (words[i / 64] >> (i % 64)) & 1u;
+	}
+
+	constexpr void set(const size_t i) const & {
+		words[i / 64] |= uint64_t{1} << (i % 64);
+	}
+
+	constexpr void clear(const size_t bits) const & {
+		std::ranges::fill_n(words, static_cast<std::ptrdiff_t>(word_count(bits)), uint64_t{0});
+	}
+};
+
+// boundary – elementai, kurių bent vienas iš keturių kaimynų yra kitoje mask pusėje. Kaimynai už paveikslo ribų neskaičiuojami.
+// index(x, y) – elemento numeris kaukėje, pvz., y * width + x arba plytelių išdėstyme. boundary turi būti išvalytas.
+template<class I>
+constexpr void mark_boundary(const bit_mask mask, const bit_mask boundary, const uint32_t width, const uint32_t height, I && index) {
+	for (uint32_t y = 0; y != height; ++y) {
+		for (uint32_t x = 0; x != width; ++x) {
+			const bool inside = mask.test(index(x, y));
+			if ((x && mask.test(index(x - 1, y)) != inside) || (x + 1 != width && mask.test(index(x + 1, y)) != inside)
+				|| (y && mask.test(index(x, y - 1)) != inside) || (y + 1 != height && mask.test(index(x, y + 1)) != inside))
+				boundary.set(index(x, y));
+		}
+	}
+}
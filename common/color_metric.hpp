@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+
+// Spalvų (0xRRGGBB) atstumai, bendri visų metų programoms. Kiekviena metrika – euklidinis atstumas kokioje nors erdvėje:
+// coordinates() paverčia spalvą tos erdvės tašku (fiksuoto kablelio sveikieji skaičiai), atstumas – squared_distance() tarp taškų.
+// box_distance() – apatinis rėžis atstumui iki bet kurios spalvos RGB gretasienyje [lo, hi] (kampai įskaičiuoti), paieškos medžiams.
+// Kai is_uniform, atstumas priklauso tik nuo poslinkio (offset_distance), todėl tinka iš anksto sugeneruoti apvalkalai.
+// Kitos metrikos gali turėti beyond() – apatinį rėžį spalvoms už sRGB apvalkalų, tada apvalkalai vis dar užbaigia daugumą paieškų.
+namespace metric {
+	using point = std::array<int32_t, 3>;
+
+	constexpr uint32_t squared_distance(const point & a, const point & b) {
+		uint32_t sum = 0;
+		for (size_t i = 0; i != 3; ++i) sum += static_cast<uint32_t>((a[i] - b[i]) * (a[i] - b[i]));
+		return sum;
+	}
+
+	constexpr std::array<uint32_t, 3> channels(const uint32_t color) {
+		return {(color >> 16) & 0xFFu, (color >> 8) & 0xFFu, color & 0xFFu};
+	}
+
+	// Kai kiekviena koordinatė didėja tik nuo savo kanalo, gretasienio vaizdas yra [coordinates(lo), coordinates(hi)].
+	template<class M>
+	constexpr uint32_t separable_box_distance(const point & q, const uint32_t lo, const uint32_t hi) {
+		const point l = M::coordinates(lo), h = M::coordinates(hi);
+		return squared_distance(q, {std::ranges::clamp(q[0], l[0], h[0]), std::ranges::clamp(q[1], l[1], h[1]), std::ranges::clamp(q[2], l[2], h[2])});
+	}
+
+	// Tiesiog sRGB kanalai.
+	struct srgb {
+		static constexpr bool is_uniform = true;
+
+		static constexpr point coordinates(const uint32_t color) {
+			const auto [r, g, b] = channels(color);
+			return {static_cast<int32_t>(r), static_cast<int32_t>(g), static_cast<int32_t>(b)};
+		}
+
+		static constexpr uint32_t offset_distance(const int32_t dr, const int32_t dg, const int32_t db) {
+			return static_cast<uint32_t>(dr * dr + dg * dg + db * db);
+		}
+
+		static constexpr uint32_t box_distance(const point & q, const uint32_t lo, const uint32_t hi) {
+			return separable_box_distance<srgb>(q, lo, hi);
+		}
+	};
+
+	// sRGB kanalai padauginti iš R, G ir B, t. y. atstumas (R dr)² + (G dg)² + (B db)². Pvz., weighted<2, 3, 1> – žalia
+	// svarbiausia, mėlyna mažiausiai, maždaug kaip šviesume.
+	template<int32_t R, int32_t G, int32_t B>
+	struct weighted {
+		static_assert(R > 0 && G > 0 && B > 0 && 255 * 255 * (R * R + G * G + B * B) < int64_t{1} << 32);
+
+		static constexpr bool is_uniform = true;
+
+		static constexpr point coordinates(const uint32_t color) {
+			const auto [r, g, b] = channels(color);
+			return {R * static_cast<int32_t>(r), G * static_cast<int32_t>(g), B * static_cast<int32_t>(b)};
+		}
+
+		static constexpr uint32_t offset_distance(const int32_t dr, const int32_t dg, const int32_t db) {
+			return static_cast<uint32_t>(R * R * dr * dr + G * G * dg * dg + B * B * db * db);
+		}
+
+		static constexpr uint32_t box_distance(const point & q, const uint32_t lo, const uint32_t hi) {
+			return separable_box_distance<weighted>(q, lo, hi);
+		}
+	};
+
+	// sRGB kanalo reikšmė tiesinėje šviesos skalėje [0, 1].
+	inline float to_linear(const uint32_t v) {
+		const float c = static_cast<float>(v) / 255.f;
+		return ((c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f));
+	}
+
+	// Tiesinis RGB, kanalas padaugintas iš 2^15 - 1. Tamsių spalvų skirtumai mažesni nei sRGB, šviesių – didesni.
+	struct linear {
+		static constexpr bool is_uniform = false;
+
+		inline static const std::array<int32_t, 256> table = [] static {
+			std::array<int32_t, 256> t;
+			for (uint32_t v = 0; v != 256; ++v) t[v] = static_cast<int32_t>(std::lround(to_linear(v) * 32767.f));
+			return t;
+		}();
+
+		// slopes[v][R] – mažiausias (table[v + o] - table[v])² / o², kai 0 < |o| <= R.
+		static constexpr uint32_t max_radius = 16;
+
+		inline static const std::array<std::array<uint32_t, max_radius + 1>, 256> slopes = [] static {
+			std::array<std::array<uint32_t, max_radius + 1>, 256> s;
+			for (int32_t v = 0; v != 256; ++v) {
+				s[v][0] = UINT32_MAX;
+				for (int32_t radius = 1; radius <= int32_t{max_radius}; ++radius) {
+					s[v][radius] = s[v][radius - 1];
+					for (const int32_t o : {-radius, radius}) {
+						if (v + o < 0 || v + o > 255) continue;
+						const int32_t d = table[v + o] - table[v];
+						s[v][radius] = std::ranges::min(s[v][radius], static_cast<uint32_t>(d * d / (o * o)));
+					}
+				}
+			}
+			return s;
+		}();
+
+		static constexpr point coordinates(const uint32_t color) {
+			const auto [r, g, b] = channels(color);
+			return {table[r], table[g], table[b]};
+		}
+
+		static constexpr uint32_t box_distance(const point & q, const uint32_t lo, const uint32_t hi) {
+			return separable_box_distance<linear>(q, lo, hi);
+		}
+
+		// Apatinis rėžis atstumui nuo color iki bet kurios spalvos, nutolusios sRGB prasme bent per sqrt(offset_distance).
+		// Jei visi |o| <= R, atstumas >= min slopes · |o|², o jei kuris |o| > R – jau vien to kanalo įnašas >= slopes · R².
+		static constexpr uint32_t beyond(const uint32_t color, const uint32_t offset_distance) {
+			uint32_t radius = 1;
+			while (radius < max_radius && radius * radius < offset_distance) ++radius;
+			const auto [r, g, b] = channels(color);
+			const uint64_t slope = std::ranges::min({slopes[r][radius], slopes[g][radius], slopes[b][radius]});
+			return static_cast<uint32_t>(std::ranges::min(slope * std::ranges::min(offset_distance, radius * radius), uint64_t{UINT32_MAX}));
+		}
+	};
+
+	// OKLab (https://bottosson.github.io/posts/oklab/), L, a ir b padauginti iš 2^14. LMS kvantuojama į 16 bitų, o kubinė šaknis
+	// imama iš lentelės. Lab netiesiškai priklauso nuo RGB, todėl box_distance tinka tik lygiuotiems kubeliams, kurių kraštinė
+	// 2^k (kaip 2025 color_index): kiekvienam jų iš anksto suskaičiuotas jo spalvų Lab gretasienis. Lentelės (apie 30 MB)
+	// sukuriamos pirmą kartą jų prireikus.
+	struct oklab {
+		static constexpr bool is_uniform = false;
+
+		static constexpr std::array<std::array<float, 3>, 3> to_lms = {{
+			{0.4122214708f, 0.5363325363f, 0.0514459929f},
+			{0.2119034982f, 0.6806995451f, 0.1073969566f},
+			{0.0883024619f, 0.2817188376f, 0.6299787005f},
+		}}, to_lab = {{
+			{0.2104542553f, 0.7936177850f, -0.0040720468f},
+			{1.9779984951f, -2.4285922050f, 0.4505937099f},
+			{0.0259040371f, 0.7827717662f, -0.8086757660f},
+		}};
+
+		// Lygyje L kubeliai turi kraštinę 2^(8 - L), lygiai 1..depth saugomi iš eilės nuo first(L).
+		static constexpr uint32_t depth = 7;
+
+		static constexpr size_t first(const uint32_t level) {
+			return ((size_t{1} << (3 * level)) - 1) / 7 - 1;
+		}
+
+		static constexpr size_t node(const uint32_t level, const uint32_t color) {
+			const uint32_t shift = 8 - level;
+			const auto [r, g, b] = channels(color);
+			return first(level) + (((r >> shift) << (2 * level)) | ((g >> shift) << level) | (b >> shift));
+		}
+
+		struct bounds {
+			std::array<int16_t, 3> lo, hi;
+		};
+
+		struct tables {
+			// lms[i][channel][v] – kanalo v įnašas į i-ąją LMS komponentę, kartu jie neviršija 0xFFFF.
+			std::array<std::array<std::array<uint32_t, 256>, 3>, 3> lms;
+			std::array<float, 0x1'00'00> cbrt;
+			std::unique_ptr<bounds[]> boxes;
+
+			point convert(const uint32_t color) const & {
+				const auto [r, g, b] = channels(color);
+				std::array<float, 3> c;
+				for (size_t i = 0; i != 3; ++i) c[i] = cbrt[std::ranges::min(lms[i][0][r] + lms[i][1][g] + lms[i][2][b], 0xFFFFu)];
+				point p;
+				for (size_t i = 0; i != 3; ++i) p[i] = static_cast<int32_t>(std::lround(to_lab[i][0] * c[0] + to_lab[i][1] * c[1] + to_lab[i][2] * c[2]));
+				return p;
+			}
+		};
+
+		static const tables & data() {
+			static const tables t = [] static {
+				tables t;
+				for (size_t i = 0; i != 3; ++i) {
+					for (size_t channel = 0; channel != 3; ++channel) {
+						for (uint32_t v = 0; v != 256; ++v) t.lms[i][channel][v] = static_cast<uint32_t>(to_lms[i][channel] * to_linear(v) * 65535.f);
+					}
+				}
+				for (uint32_t i = 0; i != 0x1'00'00; ++i) t.cbrt[i] = std::cbrt(static_cast<float>(i) / 65535.f) * 16384.f;
+
+				t.boxes = std::make_unique_for_overwrite<bounds[]>(first(depth + 1));
+				std::ranges::fill_n(t.boxes.get(), static_cast<std::ptrdiff_t>(first(depth + 1)),
+					bounds{{INT16_MAX, INT16_MAX, INT16_MAX}, {INT16_MIN, INT16_MIN, INT16_MIN}});
+				const auto merge = [](bounds & to, const std::array<int16_t, 3> & lo, const std::array<int16_t, 3> & hi) static -> void {
+					for (size_t i = 0; i != 3; ++i) {
+						to.lo[i] = std::ranges::min(to.lo[i], lo[i]);
+						to.hi[i] = std::ranges::max(to.hi[i], hi[i]);
+					}
+				};
+				for (uint32_t color = 0; color != 0x1'00'00'00u; ++color) {
+					const point p = t.convert(color);
+					const std::array<int16_t, 3> lab = {static_cast<int16_t>(p[0]), static_cast<int16_t>(p[1]), static_cast<int16_t>(p[2])};
+					merge(t.boxes[node(depth, color)], lab, lab);
+				}
+				// Vaikas lygyje level + 1 pasiekiamas per bet kurią savo spalvą, čia – mažiausią.
+				for (uint32_t level = depth - 1; level; --level) {
+					const uint32_t side = 0x100u >> (level + 1);
+					for (uint32_t r = 0; r < 0x100u; r += side) {
+						for (uint32_t g = 0; g < 0x100u; g += side) {
+							for (uint32_t b = 0; b < 0x100u; b += side) {
+								const uint32_t color = (r << 16) | (g << 8) | b;
+								const bounds & child = t.boxes[node(level + 1, color)];
+								merge(t.boxes[node(level, color)], child.lo, child.hi);
+							}
+						}
+					}
+				}
+				return t;
+			}();
+			return t;
+		}
+
+		static constexpr point coordinates(const uint32_t color) {
+			return data().convert(color);
+		}
+
+		static constexpr uint32_t box_distance(const point & q, const uint32_t lo, const uint32_t hi) {
+			const uint32_t side = ((hi >> 16) & 0xFFu) - ((lo >> 16) & 0xFFu) + 1;
+			/**/ if (side == 0x100u)	return 0;
+			else if (side == 1)		return squared_distance(q, coordinates(lo));
+
+			const bounds & box = data().boxes[node(8 - static_cast<uint32_t>(std::countr_zero(side)), lo)];
+			return squared_distance(q, {std::ranges::clamp(q[0], int32_t{box.lo[0]}, int32_t{box.hi[0]}),
+				std::ranges::clamp(q[1], int32_t{box.lo[1]}, int32_t{box.hi[1]}), std::ranges::clamp(q[2], int32_t{box.lo[2]}, int32_t{box.hi[2]})});
+		}
+	};
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "../AA/include/AA/metaprogramming/general.hpp"
+
+#include <cstddef>
+
+#ifdef _WIN32
+// Kitaip windows.h apibrėžia min ir max makrokomandas, kurios sugadina std::ranges::min(...).
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+
+// Į atmintį atvaizduotas failas, bendras visų metų programoms. Puslapius įkelia ir iškelia OS, todėl failas gali būti didesnis už RAM.
+struct mapped_file {
+	// Member objects
+private:
+	std::byte * base = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE, mapping = nullptr;
+#else
+	int file = -1;
+#endif
+
+
+
+	// Member functions
+public:
+	constexpr mapped_file() = default;
+	mapped_file(const mapped_file &) = delete;
+	mapped_file & operator=(const mapped_file &) = delete;
+	constexpr ~mapped_file() { close(); }
+
+	// Sukuria (ar perrašo) bytes dydžio failą. scratch – laikinas failas, ištrinamas uždarius.
+	constexpr bool open(const char * const path, const size_t bytes, const bool scratch) & {
+		close();
+		size = bytes;
+#ifdef _WIN32
+		file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+			(scratch ? (FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE) : FILE_ATTRIBUTE_NORMAL), nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, aa::cast<DWORD>(size >> 32), aa::cast<DWORD>(size), nullptr);
+		if (!mapping) return false;
+		base = static_cast<std::byte *>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+		return base != nullptr;
+#else
+		file = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (file == -1) return false;
+		if (scratch) unlink(path);
+		if (ftruncate(file, aa::sign(size))) return false;
+		void * const p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		if (p == MAP_FAILED) return false;
+		base = static_cast<std::byte *>(p);
+		return true;
+#endif
+	}
+
+	// Atidaro esamą failą visu jo dydžiu, nieko neperrašydamas.
+	constexpr bool open_existing(const char * const path) & {
+		close();
+#ifdef _WIN32
+		file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER bytes;
+		if (!GetFileSizeEx(file, &bytes) || !bytes.QuadPart) return false;
+		size = aa::unsign(bytes.QuadPart);
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+		if (!mapping) return false;
+		base = static_cast<std::byte *>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+		return base != nullptr;
+#else
+		file = ::open(path, O_RDWR);
+		if (file == -1) return false;
+		struct stat info;
+		if (fstat(file, &info) || !info.st_size) return false;
+		size = aa::unsign(info.st_size);
+		void * const p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		if (p == MAP_FAILED) return false;
+		base = static_cast<std::byte *>(p);
+		return true;
+#endif
+	}
+
+	// Atidaro esamą failą visu jo dydžiu tik skaitymui: į data() rašyti negalima, o tuos pačius puslapius gali dalintis keli procesai.
+	constexpr bool open_read_only(const char * const path) & {
+		close();
+#ifdef _WIN32
+		file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER bytes;
+		if (!GetFileSizeEx(file, &bytes) || !bytes.QuadPart) return false;
+		size = aa::unsign(bytes.QuadPart);
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) return false;
+		base = static_cast<std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size));
+		return base != nullptr;
+#else
+		file = ::open(path, O_RDONLY);
+		if (file == -1) return false;
+		struct stat info;
+		if (fstat(file, &info) || !info.st_size) return false;
+		size = aa::unsign(info.st_size);
+		void * const p = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+		if (p == MAP_FAILED) return false;
+		base = static_cast<std::byte *>(p);
+		return true;
+#endif
+	}
+
+	constexpr void close() & {
+#ifdef _WIN32
+		if (base) UnmapViewOfFile(base);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (base) munmap(base, size);
+		if (file != -1) ::close(file);
+		file = -1;
+#endif
+		base = nullptr;
+		size = 0;
+	}
+
+	constexpr bool is_open() const & { return base != nullptr; }
+	constexpr std::byte * data() const & { return base; }
+	constexpr size_t get_size() const & { return size; }
+
+	// Užuomina, kad sritis artimiausiu metu nebus naudojama ir ją galima iškelti pirmiausia.
+	// Windows'e VirtualUnlock neužrakintiems puslapiams juos pašalina iš darbinio rinkinio.
+	constexpr void cool(const size_t offset, const size_t bytes) const & {
+#ifdef _WIN32
+		VirtualUnlock(base + offset, bytes);
+#elif defined(MADV_COLD)
+		madvise(base + offset, bytes, MADV_COLD);
+#endif
+	}
+
+	constexpr bool flush() const & {
+#ifdef _WIN32
+		return FlushViewOfFile(base, 0) && FlushFileBuffers(file);
+#else
+		return !msync(base, size, MS_SYNC);
+#endif
+	}
+
+	// Į diską išrašo tik [offset, offset + bytes) sritį. msync reikalauja, kad pradžia būtų sistemos puslapio riboje.
+	constexpr bool flush(const size_t offset, const size_t bytes) const & {
+#ifdef _WIN32
+		return FlushViewOfFile(base + offset, bytes) && FlushFileBuffers(file);
+#else
+		const size_t start = offset / aa::unsign(sysconf(_SC_PAGESIZE)) * aa::unsign(sysconf(_SC_PAGESIZE));
+		return !msync(base + start, offset + bytes - start, MS_SYNC);
+#endif
+	}
+};
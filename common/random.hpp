@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+
+// Skaitiklinis atsitiktinių skaičių generatorius, bendras visų metų programoms.
+// i-tasis srauto skaičius priklauso tik nuo rakto ir i, todėl srautus galima skaidyti (pvz., gijoms)
+// ir generuoti paketais. Tas pats seed visada duoda tą pačią seką.
+namespace rng {
+	// https://github.com/skeeto/hash-prospector (lowbias32)
+	constexpr uint32_t mix(uint32_t x) {
+		x ^= x >> 16;
+		x *= 0x7F'EB'35'2Du;
+		x ^= x >> 15;
+		x *= 0x84'6C'A6'8Bu;
+		x ^= x >> 16;
+		return x;
+	}
+
+	// https://prng.di.unimi.it/splitmix64.c
+	constexpr uint64_t mix(uint64_t x) {
+		x += 0x9E'37'79'B9'7F'4A'7C'15u;
+		x = (x ^ (x >> 30)) * 0xBF'58'47'6D'1C'E4'E5'B9u;
+		x = (x ^ (x >> 27)) * 0x94'D0'49'BB'13'31'11'EBu;
+		return x ^ (x >> 31);
+	}
+
+	// Skaičius counter vietoje. Viršutinė skaitiklio pusė įeina į high, kad paketą būtų galima skaičiuoti be jos.
+	constexpr uint32_t high(const uint64_t key, const uint64_t counter) {
+		return static_cast<uint32_t>(key >> 32) ^ mix(static_cast<uint32_t>(counter >> 32));
+	}
+	constexpr uint32_t at(const uint64_t key, const uint64_t counter) {
+		return mix(mix(static_cast<uint32_t>(counter) ^ static_cast<uint32_t>(key)) + high(key, counter));
+	}
+
+	// [0, n) be dalybos. Nuokrypis nuo tolygaus skirstinio ne didesnis nei n / 2^32.
+	constexpr uint32_t bound(const uint32_t x, const uint32_t n) {
+		return static_cast<uint32_t>((uint64_t{x} * n) >> 32);
+	}
+
+	// [0, 1) su 24 bitų tikslumu.
+	constexpr float unit(const uint32_t x) {
+		return static_cast<float>(x >> 8) * 0x1p-24f;
+	}
+
+	// out[i] = at(key, counter + i) be vektorių.
+	constexpr void fill_scalar(const uint64_t key, const uint64_t counter, const std::span<uint32_t> out) {
+		for (size_t i = 0; i != out.size(); ++i) out[i] = at(key, counter + i);
+	}
+
+#if defined(__x86_64__) || defined(__i386__)
+	// mix aštuoniems skaičiams.
+	[[gnu::target("avx2")]]
+	inline __m256i mix8(__m256i x) {
+		x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+		x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7F'EB'35'2D));
+		x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+		x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x84'6C'A6'8Bu)));
+		return _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+	}
+
+	[[gnu::target("avx2")]]
+	inline void fill_avx2(const uint64_t key, const uint64_t counter, const std::span<uint32_t> out) {
+		const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i low_key = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(key)));
+		size_t i = 0;
+		// Paketo viduje apatinė skaitiklio pusė neturi persipildyti.
+		for (; i + 8 <= out.size() && static_cast<uint32_t>(counter + i) <= UINT32_MAX - 7; i += 8) {
+			const __m256i c = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(counter + i))), lanes);
+			const __m256i h = _mm256_set1_epi32(static_cast<int>(high(key, counter + i)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out.data() + i),
+				mix8(_mm256_add_epi32(mix8(_mm256_xor_si256(c, low_key)), h)));
+		}
+		fill_scalar(key, counter + i, out.subspan(i));
+	}
+#endif
+
+	using fill_function = void (*)(uint64_t, uint64_t, std::span<uint32_t>);
+
+	// Versija parenkama vieną kartą pagal procesorių, kaip 2025/shell_kernel.hpp.
+	inline const fill_function fill_dispatch = [] static -> fill_function {
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) return fill_avx2;
+#endif
+		return fill_scalar;
+	}();
+
+	// out[i] = at(key, counter + i).
+	constexpr void fill(const uint64_t key, const uint64_t counter, const std::span<uint32_t> out) {
+		if consteval {
+			fill_scalar(key, counter, out);
+		} else {
+			fill_dispatch(key, counter, out);
+		}
+	}
+
+	// Atsitiktinių skaičių srautas. Skaičiai generuojami paketais po batch_size ir dalinami po vieną.
+	struct stream {
+		static constexpr size_t batch_size = 16;
+
+		uint64_t key, counter = 0;
+		std::array<uint32_t, batch_size> batch;
+		size_t used = batch_size;
+
+		constexpr explicit stream(const uint64_t seed) : key{mix(seed)} {}
+
+		// Nepriklausomas srautas tam pačiam seed, pvz., i-tajai gijai.
+		constexpr stream split(const uint64_t id) const & {
+			stream s = stream{0};
+			s.key = mix(key ^ (0xD1'B5'4A'32'D1'92'ED'03u * (id + 1)));
+			return s;
+		}
+
+		constexpr uint32_t next() & {
+			if (used == batch_size) {
+				rng::fill(key, counter, batch);
+				counter += batch_size;
+				used = 0;
+			}
+			return batch[used++];
+		}
+
+		// [0, n).
+		constexpr uint32_t below(const uint32_t n) & {
+			return bound(next(), n);
+		}
+
+		// [lo, hi], kaip glm::linearRand. Intervalas turi tilpti į 32 bitus.
+		template<std::integral T>
+		constexpr T between(const T lo, const T hi) & {
+			return static_cast<T>(lo + static_cast<T>((uint64_t{next()} * (static_cast<uint64_t>(hi - lo) + 1)) >> 32));
+		}
+
+		template<std::floating_point T>
+		constexpr T between(const T lo, const T hi) & {
+			return lo + (hi - lo) * static_cast<T>(unit(next()));
+		}
+
+		// Dideliems kiekiams: visas paketas tiesiai į out, pro tarpinį buferį.
+		constexpr void fill_below(const std::span<uint32_t> out, const uint32_t n) & {
+			rng::fill(key, counter, out);
+			counter += out.size();
+			for (uint32_t & x : out) x = bound(x, n);
+		}
+
+		constexpr void fill_unit(const std::span<float> out) & {
+			std::array<uint32_t, 64> raw;
+			for (size_t i = 0; i < out.size(); i += raw.size()) {
+				const size_t size = std::ranges::min(raw.size(), out.size() - i);
+				rng::fill(key, counter, {raw.data(), size});
+				counter += size;
+				for (size_t j = 0; j != size; ++j) out[i + j] = unit(raw[j]);
+			}
+		}
+	};
+
+	// Komandinės eilutės seed. Jei jo nėra arba jis netinkamas, imamas laikrodis.
+	inline uint64_t parse_seed(const std::optional<std::string_view> arg) {
+		if (arg) {
+			uint64_t seed = 0;
+			const auto [ptr, ec] = std::from_chars(arg->data(), arg->data() + arg->size(), seed);
+			if (ec == std::errc{} && ptr == arg->data() + arg->size()) return seed;
+		}
+		return static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+
+// Paveikslų įrašymas atskiroje gijoje, bendras visų metų programoms. push() tik perkelia jau nukopijuotą paveikslą į eilę,
+// todėl UI gija nelaukia kodavimo ir disko. Baigus kiekvieną įrašą rašymo gijoje kviečiamas notify (pvz., įvykiui išsiųsti),
+// o rezultatus UI gija pasiima per consume().
+template<class IMAGE>
+struct save_queue {
+	// Member types
+	using save_function = bool (*)(const IMAGE &, const std::string &);
+	using notify_function = void (*)(void *);
+
+
+
+	// Member objects
+private:
+	struct job {
+		IMAGE image;
+		std::string path;
+	};
+
+	save_function save = nullptr;
+	notify_function notify = nullptr;
+	void * userdata = nullptr;
+
+	std::mutex lock;
+	std::condition_variable ready;
+	std::deque<job> jobs;
+	std::vector<std::pair<std::string, bool>> done;
+	bool is_closing = false;
+
+	// Paskutinis, kad būtų sustabdytas pirmiau nei sunaikinama eilė.
+	std::jthread writer;
+
+
+
+	// Member functions
+	void write_jobs() & {
+		while (true) {
+			job j;
+			{
+				std::unique_lock guard = std::unique_lock{lock};
+				ready.wait(guard, [&] -> bool { return is_closing || !jobs.empty(); });
+				if (jobs.empty()) return;
+				j = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			const bool ok = save(j.image, j.path);
+			{
+				const std::scoped_lock guard = std::scoped_lock{lock};
+				done.emplace_back(std::move(j.path), ok);
+			}
+			if (notify) notify(userdata);
+		}
+	}
+
+public:
+	save_queue() = default;
+	save_queue(const save_queue &) = delete;
+	save_queue & operator=(const save_queue &) = delete;
+	~save_queue() { finish(); }
+
+	void start(const save_function s, const notify_function n = nullptr, void * const u = nullptr) & {
+		save = s;
+		notify = n;
+		userdata = u;
+		is_closing = false;
+		writer = std::jthread{[this] -> void { write_jobs(); }};
+	}
+
+	void push(IMAGE && image, std::string && path) & {
+		{
+			const std::scoped_lock guard = std::scoped_lock{lock};
+			jobs.emplace_back(std::move(image), std::move(path));
+		}
+		ready.notify_one();
+	}
+
+	// f(path, ok) kiekvienam nuo praeito kvietimo baigtam įrašui.
+	template<class F>
+	void consume(F && f) & {
+		std::vector<std::pair<std::string, bool>> finished;
+		{
+			const std::scoped_lock guard = std::scoped_lock{lock};
+			finished.swap(done);
+		}
+		for (const auto & [path, ok] : finished) f(path, ok);
+	}
+
+	// Įrašo visus laukiančius paveikslus ir sustabdo giją. Po to galima vėl kviesti start().
+	void finish() & {
+		if (!writer.joinable()) return;
+		{
+			const std::scoped_lock guard = std::scoped_lock{lock};
+			is_closing = true;
+		}
+		ready.notify_one();
+		writer.join();
+	}
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <print>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+
+// Vidinis profiliavimas, bendras visų metų programoms. Veikia tik kompiliuojant su -DTRACE, kitaip visi kvietimai tušti
+// ir kompiliatorius juos išmeta. Skaitikliai ir histogramos sumuojami atomiškai, laiko intervalai ir mėginiai rašomi į
+// kiekvienos gijos buferį. finish() įrašo Chrome/Perfetto trace JSON (chrome://tracing, ui.perfetto.dev) ir atspausdina suvestinę.
+// Visi vardai turi būti eilučių literalai.
+namespace trace {
+#ifdef TRACE
+	inline constexpr bool enabled = true;
+#else
+	inline constexpr bool enabled = false;
+#endif
+
+	using clock = std::chrono::steady_clock;
+	inline const clock::time_point origin = clock::now();
+
+	constexpr uint64_t now() {
+		if constexpr (!enabled) return 0;
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - origin).count());
+	}
+
+	// Registruojami sukuriant, todėl turi būti statiniai (inline kintamieji antraštėse).
+	struct counter {
+		std::string_view name;
+		std::atomic<uint64_t> value = 0;
+		counter * next;
+
+		inline static counter * all = nullptr;
+
+		constexpr explicit counter(const std::string_view n) : name{n}, next{std::exchange(all, this)} {}
+
+		constexpr void add(const uint64_t amount = 1) & {
+			if constexpr (enabled) value.fetch_add(amount, std::memory_order::relaxed);
+		}
+	};
+
+	// LOG – krepšys i talpina [2^(i-1), 2^i), kitaip reikšmė i patenka į krepšį i. Per didelės reikšmės – į paskutinį.
+	struct histogram {
+		static constexpr size_t bucket_count = 64;
+
+		std::string_view name;
+		bool is_log;
+		std::array<std::atomic<uint64_t>, bucket_count> buckets = {};
+		histogram * next;
+
+		inline static histogram * all = nullptr;
+
+		constexpr histogram(const std::string_view n, const bool log) : name{n}, is_log{log}, next{std::exchange(all, this)} {}
+
+		constexpr void add(const uint64_t v) & {
+			if constexpr (enabled) {
+				const size_t bucket = std::ranges::min(is_log ? static_cast<size_t>(std::bit_width(v)) : static_cast<size_t>(v), bucket_count - 1);
+				buckets[bucket].fetch_add(1, std::memory_order::relaxed);
+			}
+		}
+	};
+
+	struct event {
+		std::string_view name;
+		uint64_t begin, duration;
+		double value;
+		bool is_sample;
+	};
+
+	struct thread_buffer {
+		uint32_t id;
+		std::vector<event> events;
+	};
+
+	inline std::mutex buffers_lock;
+	inline std::vector<std::unique_ptr<thread_buffer>> buffers;
+
+	inline thread_buffer & local() {
+		thread_local thread_buffer * buffer = [] static -> thread_buffer * {
+			const std::scoped_lock guard = std::scoped_lock{buffers_lock};
+			return buffers.emplace_back(std::make_unique<thread_buffer>(static_cast<uint32_t>(buffers.size()), std::vector<event>{})).get();
+		}();
+		return *buffer;
+	}
+
+	// Baigtas intervalas [begin, end).
+	constexpr void span(const std::string_view name, const uint64_t begin, const uint64_t end) {
+		if constexpr (enabled) local().events.emplace_back(name, begin, end - begin, 0.0, false);
+	}
+
+	// Laiko eilutė, pvz., krašto dydis.
+	constexpr void sample(const std::string_view name, const double value) {
+		if constexpr (enabled) local().events.emplace_back(name, now(), 0, value, true);
+	}
+
+	// Intervalas nuo sukūrimo iki sunaikinimo.
+	struct scope {
+		std::string_view name;
+		uint64_t begin = now();
+
+		constexpr explicit scope(const std::string_view n) : name{n} {}
+		constexpr ~scope() { span(name, begin, now()); }
+	};
+
+	// Trukmė nanosekundėmis pridedama prie skaitiklio. Tinka dažniems veiksmams, kuriems atskiri intervalai per brangūs.
+	struct timed {
+		counter & total;
+		uint64_t begin = now();
+
+		constexpr explicit timed(counter & c) : total{c} {}
+		constexpr ~timed() { total.add(now() - begin); }
+	};
+
+	// Vienodo darbo kiekio dalys, pvz., kas 65536 pikselius. lap() užbaigia dabartinę dalį ir pradeda kitą.
+	struct laps {
+		std::string_view name;
+		uint64_t begin = now();
+
+		constexpr explicit laps(const std::string_view n) : name{n} {}
+
+		constexpr void lap() & {
+			if constexpr (enabled) {
+				const uint64_t end = now();
+				span(name, begin, end);
+				begin = end;
+			}
+		}
+	};
+
+	inline bool write_json(const char * const path) {
+		std::FILE * const file = std::fopen(path, "wb");
+		if (!file) return false;
+
+		std::print(file, "{{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+		bool first = true;
+		const std::scoped_lock guard = std::scoped_lock{buffers_lock};
+		for (const std::unique_ptr<thread_buffer> & buffer : buffers) {
+			for (const event & e : buffer->events) {
+				if (e.is_sample)	std::print(file, "{}\n{{\"name\": \"{}\", \"ph\": \"C\", \"ts\": {}, \"pid\": 1, \"tid\": {}, \"args\": {{\"value\": {}}}}}",
+					(std::exchange(first, false) ? "" : ","), e.name, static_cast<double>(e.begin) / 1e3, buffer->id, e.value);
+				else				std::print(file, "{}\n{{\"name\": \"{}\", \"ph\": \"X\", \"ts\": {}, \"dur\": {}, \"pid\": 1, \"tid\": {}}}",
+					(std::exchange(first, false) ? "" : ","), e.name, static_cast<double>(e.begin) / 1e3, static_cast<double>(e.duration) / 1e3, buffer->id);
+			}
+		}
+		std::print(file, "\n]}}\n");
+		return !std::fclose(file);
+	}
+
+	inline void print_summary(std::FILE * const out) {
+		std::println(out, "{:<32} {:>10} {:>14} {:>12}", "span", "count", "total ms", "mean us");
+		std::vector<std::pair<std::string_view, std::pair<uint64_t, uint64_t>>> spans;
+		{
+			const std::scoped_lock guard = std::scoped_lock{buffers_lock};
+			for (const std::unique_ptr<thread_buffer> & buffer : buffers) {
+				for (const event & e : buffer->events) {
+					if (e.is_sample) continue;
+					auto found = std::ranges::find(spans, e.name, &decltype(spans)::value_type::first);
+					if (found == spans.end()) found = spans.insert(found, {e.name, {}});
+					++found->second.first;
+					found->second.second += e.duration;
+				}
+			}
+		}
+		for (const auto & [name, totals] : spans) {
+			std::println(out, "{:<32} {:>10} {:>14.3f} {:>12.3f}", name, totals.first,
+				static_cast<double>(totals.second) / 1e6, static_cast<double>(totals.second) / 1e3 / static_cast<double>(totals.first));
+		}
+
+		std::println(out, "\n{:<32} {:>20}", "counter", "value");
+		for (const counter * c = counter::all; c; c = c->next) {
+			std::println(out, "{:<32} {:>20}", c->name, c->value.load(std::memory_order::relaxed));
+		}
+
+		for (const histogram * h = histogram::all; h; h = h->next) {
+			std::println(out, "\n{:<32} {:>20}", h->name, "count");
+			for (size_t bucket = 0; bucket != histogram::bucket_count; ++bucket) {
+				const uint64_t count = h->buckets[bucket].load(std::memory_order::relaxed);
+				if (!count) continue;
+				std::println(out, "  {:<30} {:>20}", (h->is_log
+					? std::format("[{}, {})", (bucket ? (uint64_t{1} << (bucket - 1)) : 0), (uint64_t{1} << bucket))
+					: std::format("{}", bucket)), count);
+			}
+		}
+	}
+
+	// Įrašo trace JSON į json_path ir atspausdina suvestinę. Be TRACE nieko nedaro.
+	inline bool finish(const char * const json_path, std::FILE * const summary = stdout) {
+		if constexpr (!enabled) return true;
+		print_summary(summary);
+		return write_json(json_path);
+	}
+}